@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+
+#include "Image.hpp"
+#include "FilePath.hpp"
+#include "JobSystem.hpp"
+
+namespace glimac {
+
+// Asynchronous image decoding: every loadImage() becomes a job of the JobSystem, so all the images of a
+// scene decode in parallel while the GL thread goes on (shader compilation, meshes, first frames). The GL
+// thread collects the decoded images with update() and uploads them; until then it draws with placeholders.
+// Startup then costs about the decoding of the largest image instead of the sum of all of them.
+// With a single thread JobSystem, images are decoded in loadImage() itself, in request order.
+class AssetLoader {
+public:
+    // Called on the GL thread for each image: id as returned by loadImage(), image null if decoding failed
+    typedef std::function<void(unsigned int id, std::unique_ptr<Image> image)> ImageCallback;
+
+    AssetLoader();
+
+    // Waits for the decodings still running
+    ~AssetLoader();
+
+    // Queue the decoding of an image into format, resampled to width x height if both are given and with
+    // its mip chain if mipmaps is set (resampling and mipmaps are done by the job as well).
+    // Returns the id of the image, counted from 0 in request order.
+    unsigned int loadImage(const FilePath& filepath, PixelFormat format = PixelFormat::RGBA32F,
+                           unsigned int width = 0, unsigned int height = 0, bool mipmaps = false);
+
+    // Hand the images decoded since the last call to callback, in completion order; returns their count
+    unsigned int update(const ImageCallback& callback);
+
+    // Images requested and not yet handed over by update()
+    unsigned int getPendingCount() const {
+        return m_Requested - m_Delivered;
+    }
+
+    // Block until every requested image is decoded (update() still has to be called)
+    void wait();
+
+private:
+    AssetLoader(const AssetLoader&);
+    AssetLoader& operator =(const AssetLoader&);
+
+    struct DecodedImage {
+        unsigned int id;
+        std::unique_ptr<Image> image;
+    };
+
+    std::mutex m_Mutex; // protects m_Decoded, filled by the jobs
+    std::vector<DecodedImage> m_Decoded;
+    std::vector<JobHandle> m_Jobs;
+    unsigned int m_Requested;
+    unsigned int m_Delivered;
+};
+
+}
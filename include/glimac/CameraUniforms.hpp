@@ -0,0 +1,51 @@
+#pragma once
+
+#include "common.hpp"
+#include "StreamBuffer.hpp"
+
+namespace glimac {
+
+// Binding point of the Camera uniform block shared by every program
+const GLuint CAMERA_UNIFORM_BINDING = 0;
+
+// Per-frame data, same std140 layout as the Camera block of the shaders:
+// layout(std140) uniform Camera { mat4 uViewMatrix; mat4 uProjMatrix; mat4 uViewProjMatrix; float uTime; };
+struct CameraUniforms {
+    glm::mat4 ViewMatrix;
+    glm::mat4 ProjMatrix;
+    glm::mat4 ViewProjMatrix;
+    GLfloat time;
+    GLfloat padding[3];
+};
+
+// Uniform buffer holding CameraUniforms, bound once to CAMERA_UNIFORM_BINDING and updated once per frame
+class CameraUniformBuffer {
+public:
+    CameraUniformBuffer();
+
+    ~CameraUniformBuffer();
+
+    void update(const glm::mat4& ViewMatrix, const glm::mat4& ProjMatrix, GLfloat time);
+
+    // Same, but the block is written into the frame's region of stream and bound from there
+    // (falls back to update() if the region is full)
+    void update(StreamBuffer& stream, const glm::mat4& ViewMatrix, const glm::mat4& ProjMatrix, GLfloat time);
+
+    // Values of the last update, for CPU side culling and LOD selection
+    const CameraUniforms& getUniforms() const {
+        return m_Uniforms;
+    }
+
+private:
+    CameraUniformBuffer(const CameraUniformBuffer&);
+    CameraUniformBuffer& operator =(const CameraUniformBuffer&);
+
+    GLuint m_Buffer;
+    GLint m_OffsetAlignment; // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    CameraUniforms m_Uniforms;
+};
+
+// Connect the Camera block of a program, if it declares one, to CAMERA_UNIFORM_BINDING
+void bindCameraBlock(GLuint program);
+
+}
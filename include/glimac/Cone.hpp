@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "common.hpp"
+#include "PackedVertex.hpp"
 
 namespace glimac {
     
@@ -28,9 +29,25 @@ public:
         return m_nVertexCount;
     }
 
+    // Renvoit le pointeur vers les indices (triangles)
+    const GLuint* getIndexPointer() const {
+        return &m_Indices[0];
+    }
+
+    // Renvoit le nombre d'indices
+    GLsizei getIndexCount() const {
+        return m_Indices.size();
+    }
+
+    // Renvoit les sommets au format compact (memes indices)
+    std::vector<PackedShapeVertex> getPackedData(VertexQuantization &quantization) const {
+        return packShapeVertices(m_Vertices.data(), m_nVertexCount, quantization);
+    }
+
 private:
     std::vector<ShapeVertex> m_Vertices;
-    GLsizei m_nVertexCount; // Nombre de sommets
+    std::vector<GLuint> m_Indices;
+    GLsizei m_nVertexCount; // Nombre de sommets distincts
 };
     
 }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstdio>
+
+#include "common.hpp"
+#include "FilePath.hpp"
+#include "JobSystem.hpp"
+
+namespace glimac {
+
+// Export of the rendered frames without stalling the render loop. capture() only queues a glReadPixels
+// into a pixel pack buffer of a ring of bufferCount. The buffers whose copy is done (fence polled, never
+// waited for), normally the one filled bufferCount - 1 frames earlier (N-2 with 3 buffers), are then mapped,
+// copied to a CPU frame of a fixed pool and encoded (flipped and converted) by a job of the JobSystem. The output format follows the extension of the output path:
+//   .png         one file per frame, path_000000.png, path_000001.png...
+//   .y4m         a single YUV 4:2:0 stream (BT.601), readable by ffmpeg and most players
+//   .rgb / .raw  a single stream of rgb24 frames (ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH)
+// Streams are appended in frame order by whichever job completes the next frame, no job waits for another.
+// When the GPU is so far behind that the ring wraps onto a copy not done yet, or the jobs fall behind
+// and every CPU frame is in use, frames are dropped (and counted) rather than blocking the render loop.
+// The pool does not grow with the core count: a 1080p frame takes about 20 MB (pixels and encoding buffers).
+class FrameCapture {
+public:
+    enum Format { PNG, Y4M, RAW };
+
+    // frameCount: CPU frames being encoded at most, bufferCount: pixel pack buffers of the ring
+    FrameCapture(GLsizei width, GLsizei height, const FilePath& outputPath, unsigned int framesPerSecond = 60,
+                 unsigned int frameCount = 4, GLuint bufferCount = 3);
+
+    ~FrameCapture();
+
+    // Queue the readback of the color buffer of framebuffer (0 for the window), once the frame is drawn and
+    // before swapping
+    void capture(GLuint framebuffer);
+
+    // Read back the frames still in the ring (the only place that waits for the GPU), wait for the encoding
+    // jobs and close the output
+    void finish();
+
+    Format getFormat() const {
+        return m_Format;
+    }
+
+    // False if the output could not be opened
+    bool isValid() const {
+        return m_Valid;
+    }
+
+    // Frames handed to the encoding jobs (and written, once finish() has returned)
+    unsigned int getCapturedCount() const {
+        return m_Captured;
+    }
+
+    unsigned int getDroppedCount() const {
+        return m_Dropped;
+    }
+
+private:
+    FrameCapture(const FrameCapture&);
+    FrameCapture& operator =(const FrameCapture&);
+
+    struct Slot {
+        GLuint buffer;
+        GLsync fence; // placed after the glReadPixels, nullptr once read back
+
+        Slot(): buffer(0), fence(nullptr) {
+        }
+    };
+
+    // A CPU frame of the pool, with the buffers of its encoding
+    struct Frame {
+        unsigned int index; // position in the output, dropped frames excluded
+        std::vector<unsigned char> pixels; // RGBA, bottom row first
+        std::vector<unsigned char> scratch, output;
+    };
+
+    // Hand the frame of slot to an encoding job; false if wait is not set and the GPU copy is not done yet
+    bool readBack(Slot& slot, bool wait);
+    // Read back the slots whose copy is done, oldest first
+    void readBackCompleted();
+    void encode(Frame& frame) const;
+    void write(Frame& frame);
+
+    GLsizei m_Width, m_Height;
+    std::string m_Path; // output path without its extension
+    Format m_Format;
+    bool m_Valid;
+    std::FILE* m_Stream; // Y4M and RAW output
+
+    std::vector<Slot> m_Slots;
+    unsigned int m_Frame; // frames passed to capture()
+    unsigned int m_Captured;
+    unsigned int m_Dropped;
+    std::vector<std::unique_ptr<Frame>> m_Frames; // the pool
+    std::vector<JobHandle> m_Jobs;
+
+    std::mutex m_Mutex; // protects the members below, used by the jobs
+    std::vector<Frame*> m_FreeFrames;
+    std::map<unsigned int, Frame*> m_Encoded; // stream frames waiting for their turn
+    unsigned int m_NextWrite; // streams are written in order
+    bool m_Writing; // a job is appending to the stream
+};
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+#include "BBox.hpp"
+
+namespace glimac {
+
+// Six clipping planes (left, right, bottom, top, near, far) as (n, d) with n.p + d >= 0 inside,
+// normalized so that n.p + d is a signed distance
+struct Frustum {
+    glm::vec4 planes[6];
+};
+
+// Planes of the volume clipped by clipMatrix (Gribb-Hartmann). With ProjMatrix * ViewMatrix the
+// planes are in world space, with ProjMatrix alone they are in view space.
+Frustum extractFrustum(const glm::mat4& clipMatrix);
+
+// True if the sphere is at least partially inside the frustum
+bool intersects(const Frustum& frustum, const glm::vec3& center, float radius);
+
+inline bool intersects(const Frustum& frustum, const BBox3f& bbox) {
+    glm::vec3 c;
+    float radius;
+    boundingSphere(bbox, c, radius);
+    return intersects(frustum, c, radius);
+}
+
+// Bounding spheres stored as structure of arrays so they can be tested 4 (SSE) or 8 (AVX) at a time
+struct BoundingSpheres {
+    std::vector<float> x, y, z, radius;
+
+    void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+    }
+
+    void reserve(size_t count) {
+        x.reserve(count);
+        y.reserve(count);
+        z.reserve(count);
+        radius.reserve(count);
+    }
+
+    void resize(size_t count) {
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+        radius.resize(count);
+    }
+
+    void push_back(const glm::vec3& center, float r) {
+        x.push_back(center.x);
+        y.push_back(center.y);
+        z.push_back(center.z);
+        radius.push_back(r);
+    }
+
+    size_t size() const {
+        return x.size();
+    }
+};
+
+// Append to visible the indices of the spheres intersecting the frustum, in increasing order.
+// Returns the number of visible spheres.
+size_t cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, std::vector<GLuint>& visible);
+
+}
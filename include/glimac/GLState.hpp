@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <GL/glew.h>
+
+namespace glimac {
+
+// Shadow copy of the GL state the application changes every frame: bound program, VAO,
+// GL_ARRAY_BUFFER, active texture unit, textures per unit and target, and capabilities.
+// Calls that would set a value already in place are skipped and counted.
+// Every glimac and space call site goes through it; code that changes this state behind its
+// back must call invalidate() afterwards, as must the application once its context is created
+// and before any other call, so that the state starts unknown.
+class GLState {
+public:
+    static const GLuint MAX_TEXTURE_UNITS = 16;
+
+    struct Counters {
+        size_t issued;
+        size_t elided;
+    };
+
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint vao);
+
+    // Only GL_ARRAY_BUFFER is shadowed: GL_ELEMENT_ARRAY_BUFFER belongs to the bound VAO
+    // and other targets are rarely rebound, those calls are always issued
+    static void bindBuffer(GLenum target, GLuint buffer);
+
+    // unit is an index (0 for GL_TEXTURE0)
+    static void activeTexture(GLuint unit);
+
+    // Bind on the active unit
+    static void bindTexture(GLenum target, GLuint texture);
+
+    // Bind on the given unit, which becomes the active one
+    static void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    static void enable(GLenum capability);
+    static void disable(GLenum capability);
+    static void setEnabled(GLenum capability, bool enabled);
+
+    // Delete objects and forget their bindings, a new object may reuse the name
+    static void deleteProgram(GLuint program);
+    static void deleteVertexArrays(GLsizei count, const GLuint* vaos);
+    static void deleteBuffers(GLsizei count, const GLuint* buffers);
+    static void deleteTextures(GLsizei count, const GLuint* textures);
+
+    // Forget everything: the next call of each kind is issued
+    static void invalidate();
+
+    // Start counting a new frame, the previous frame's counters stay readable
+    static void newFrame();
+
+    static Counters getFrameCounters() {
+        return m_LastFrame;
+    }
+
+private:
+    static bool update(GLuint& shadow, GLuint value);
+
+    static GLuint m_Program;
+    static GLuint m_VertexArray;
+    static GLuint m_ArrayBuffer;
+    static GLuint m_ActiveUnit;
+    static GLuint m_Textures[MAX_TEXTURE_UNITS][4];
+    static GLuint m_Capabilities[4];
+    static Counters m_Frame;
+    static Counters m_LastFrame;
+};
+
+}
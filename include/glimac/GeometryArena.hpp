@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+#include "PackedVertex.hpp"
+
+namespace glimac {
+
+// Location of a mesh inside a GeometryArena. Indices are relative to the mesh: draw them with
+// glDrawElements*BaseVertex at byte offset firstIndex * sizeof(GLuint) and baseVertex.
+struct MeshHandle {
+    GLint baseVertex;   // first vertex of the mesh in the arena vertex buffer
+    GLsizei vertexCount;
+    GLsizei firstIndex; // first index of the mesh in the arena index buffer
+    GLsizei indexCount;
+    VertexQuantization quantization; // position decoding when the arena is packed
+
+    MeshHandle(): baseVertex(0), vertexCount(0), firstIndex(0), indexCount(0) {
+    }
+};
+
+// Static meshes suballocated from a single vertex buffer and a single index buffer, with one VAO
+// describing them all: switching between shapes only changes the draw range, never the bindings.
+// Meshes are added (and converted to the packed layout if requested) on the CPU, then sent in one go
+// by upload(). Handles are valid as soon as add() returns, the GL objects only after upload().
+// Meshes added after upload() are rejected: add() logs an error and returns an empty handle.
+class GeometryArena {
+public:
+    GeometryArena(bool packedVertices = false, GLuint position = 0, GLuint normal = 1, GLuint texCoords = 2);
+
+    ~GeometryArena();
+
+    MeshHandle add(const ShapeVertex* vertices, GLsizei vertexCount, const GLuint* indices, GLsizei indexCount);
+
+    template<typename Shape>
+    MeshHandle add(const Shape& shape) {
+        return add(shape.getDataPointer(), shape.getVertexCount(), shape.getIndexPointer(), shape.getIndexCount());
+    }
+
+    // Create the buffers and the VAO once every mesh has been added, then release the CPU copies
+    void upload();
+
+    GLuint getVertexArray() const {
+        return m_VAO;
+    }
+
+    GLuint getVertexBuffer() const {
+        return m_VBO;
+    }
+
+    GLuint getIndexBuffer() const {
+        return m_IBO;
+    }
+
+    bool isPacked() const {
+        return m_Packed;
+    }
+
+    // Registry of the meshes, in the order they were added
+    GLsizei getMeshCount() const {
+        return m_Meshes.size();
+    }
+
+    const MeshHandle& getMesh(GLsizei index) const {
+        return m_Meshes[index];
+    }
+
+private:
+    GeometryArena(const GeometryArena&);
+    GeometryArena& operator =(const GeometryArena&);
+
+    bool m_Packed;
+    GLuint m_AttribPosition, m_AttribNormal, m_AttribTexCoords;
+    std::vector<ShapeVertex> m_Vertices;
+    std::vector<PackedShapeVertex> m_PackedVertices;
+    std::vector<GLuint> m_Indices;
+    std::vector<MeshHandle> m_Meshes;
+    GLsizei m_VertexCount;
+    GLuint m_VBO;
+    GLuint m_IBO;
+    GLuint m_VAO;
+};
+
+}
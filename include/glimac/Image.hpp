@@ -9,14 +9,34 @@
 
 namespace glimac {
 
+// Pixel layout of an Image. The 8 bit formats store one byte per channel; the sRGB ones hold colors
+// encoded with the sRGB transfer function, as in image files, and their alpha (if any) stays linear.
+// RGBA32F stores one float per channel (16 bytes per pixel).
+enum class PixelFormat {
+    RGBA8,
+    RGB8,
+    SRGB8,
+    SRGB8_ALPHA8,
+    RGBA32F
+};
+
+unsigned int getChannelCount(PixelFormat format);
+
+unsigned int getBytesPerPixel(PixelFormat format);
+
+bool isSRGB(PixelFormat format);
+
 class Image {
 private:
     unsigned int m_nWidth = 0u;
     unsigned int m_nHeight = 0u;
-    std::unique_ptr<glm::vec4[]> m_Pixels;
+    PixelFormat m_Format = PixelFormat::RGBA32F;
+    std::unique_ptr<unsigned char[]> m_Data;
+    std::vector<std::unique_ptr<Image>> m_Mipmaps; // levels 1, 2... if generated
 public:
-    Image(unsigned int width, unsigned int height):
-        m_nWidth(width), m_nHeight(height), m_Pixels(new glm::vec4[width * height]) {
+    Image(unsigned int width, unsigned int height, PixelFormat format = PixelFormat::RGBA32F):
+        m_nWidth(width), m_nHeight(height), m_Format(format),
+        m_Data(new unsigned char[size_t(width) * height * getBytesPerPixel(format)]) {
     }
 
     unsigned int getWidth() const {
@@ -27,16 +47,55 @@ public:
         return m_nHeight;
     }
 
+    PixelFormat getFormat() const {
+        return m_Format;
+    }
+
+    // Rows from top to bottom, without padding
+    const unsigned char* getData() const {
+        return m_Data.get();
+    }
+
+    unsigned char* getData() {
+        return m_Data.get();
+    }
+
+    size_t getDataSize() const {
+        return size_t(m_nWidth) * m_nHeight * getBytesPerPixel(m_Format);
+    }
+
+    // RGBA32F images only
     const glm::vec4* getPixels() const {
-        return m_Pixels.get();
+        return reinterpret_cast<const glm::vec4*>(m_Data.get());
     }
 
     glm::vec4* getPixels() {
-        return m_Pixels.get();
+        return reinterpret_cast<glm::vec4*>(m_Data.get());
+    }
+
+    // Set every pixel to color, given in the encoding of the format (sRGB values for the sRGB formats)
+    void fill(const glm::vec4& color);
+
+    // Precompute the mip chain down to 1x1, each level box filtered from the previous one (in linear space)
+    void generateMipmaps();
+
+    // 1 + the number of generated mipmaps
+    unsigned int getLevelCount() const {
+        return 1 + m_Mipmaps.size();
+    }
+
+    // Level 0 is the image itself
+    const Image& getLevel(unsigned int level) const {
+        return level == 0 ? *this : *m_Mipmaps[level - 1];
     }
 };
 
-std::unique_ptr<Image> loadImage(const FilePath& filepath);
+// Decode an image file; RGBA32F (the default) keeps the values of the file divided by 255
+std::unique_ptr<Image> loadImage(const FilePath& filepath, PixelFormat format = PixelFormat::RGBA32F);
+
+// Resample an image to width x height (box filter when shrinking, bilinear when enlarging), in the same format.
+// 8 bit sRGB colors are filtered in linear space.
+std::unique_ptr<Image> resizeImage(const Image& image, unsigned int width, unsigned int height);
 
 class ImageManager {
 private:
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <functional>
+
+namespace glimac {
+
+struct Job;
+
+// Shared handle on a job: keeps it readable (isDone(), wait()) after it has run
+typedef std::shared_ptr<Job> JobHandle;
+
+// Work-stealing scheduler: a fixed pool of worker threads, each owning a Chase-Lev deque. A thread pushes
+// and pops its own jobs at the bottom of its deque (LIFO, cache friendly), idle threads steal from the top
+// of a random other deque (FIFO, the largest pieces of work). Threads that are not part of the pool hand
+// their jobs over through a shared queue. Workers that find nothing spin briefly, then sleep until new
+// jobs are pushed, so a large pool costs nothing while idle.
+//
+// A job finishes once its function and all its children (jobs created with it as parent) are done.
+// A job with dependencies only starts once they all have finished: addDependency() builds graphs and
+// then() chains continuations. wait() runs other jobs while waiting, it never blocks a thread of the pool.
+//
+// initialize(1) is a deterministic single thread mode for debugging: jobs run on the calling thread,
+// in program order, as soon as they are ready. Without initialize(), the scheduler is in that mode.
+class JobSystem {
+public:
+    // threadCount: threads running jobs, the calling thread included (0: one per hardware thread)
+    static void initialize(unsigned int threadCount = 0);
+
+    // Stop and join the workers; jobs still queued are run first
+    static void shutdown();
+
+    static unsigned int getThreadCount();
+
+    // A job to run(); it counts as a child of parent until it is finished
+    static JobHandle create(std::function<void()> work, const JobHandle& parent = JobHandle());
+
+    // job will not start before dependency has finished; to be called before run(job)
+    static void addDependency(const JobHandle& job, const JobHandle& dependency);
+
+    // Schedule the job: it starts as soon as its dependencies are finished
+    static void run(const JobHandle& job);
+
+    // Create and schedule a continuation: work runs once job has finished
+    static JobHandle then(const JobHandle& job, std::function<void()> work);
+
+    static bool isDone(const JobHandle& job);
+
+    // Run jobs until job is finished
+    static void wait(const JobHandle& job);
+
+    // Call body(first, last) over [begin, end) split into ranges of grain indices (0: a few ranges per
+    // thread), in parallel, and return once all ranges are done
+    static void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body);
+};
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+#include "BBox.hpp"
+#include "PackedVertex.hpp"
+
+namespace glimac {
+
+// One tessellation level of a LodMesh, as a range of its index buffer
+struct LodLevel {
+    GLsizei firstIndex;
+    GLsizei indexCount;
+    float geometricError; // max distance between the mesh and the true surface, in object units
+};
+
+// Chain of tessellation levels of the same shape, stored in a single vertex/index buffer so the
+// caller sets up one VBO/IBO/VAO and only the drawn index range changes with the level.
+// Levels are ordered from the finest (0) to the coarsest.
+class LodMesh {
+public:
+    LodMesh(): m_BBox(glm::vec3(0.f)) {
+    }
+
+    // Append a level; its indices refer to its own vertices and are offset internally
+    void addLevel(const ShapeVertex* vertices, GLsizei vertexCount,
+                  const GLuint* indices, GLsizei indexCount, float geometricError);
+
+    // Coarsest level whose geometric error projects to at most maxPixelError pixels.
+    // distance: from the eye to the closest point of the mesh, in object units (view distance / scale),
+    // pixelsPerUnit: see projectedPixelsPerUnit()
+    GLsizei selectLevel(float distance, float pixelsPerUnit, float maxPixelError) const;
+
+    const ShapeVertex* getDataPointer() const {
+        return &m_Vertices[0];
+    }
+
+    GLsizei getVertexCount() const {
+        return m_Vertices.size();
+    }
+
+    const GLuint* getIndexPointer() const {
+        return &m_Indices[0];
+    }
+
+    GLsizei getIndexCount() const {
+        return m_Indices.size();
+    }
+
+    std::vector<PackedShapeVertex> getPackedData(VertexQuantization& quantization) const {
+        return packShapeVertices(m_Vertices.data(), m_Vertices.size(), quantization);
+    }
+
+    GLsizei getLevelCount() const {
+        return m_Levels.size();
+    }
+
+    const LodLevel& getLevel(GLsizei level) const {
+        return m_Levels[level];
+    }
+
+    const BBox3f& getBoundingBox() const {
+        return m_BBox;
+    }
+
+private:
+    std::vector<ShapeVertex> m_Vertices;
+    std::vector<GLuint> m_Indices;
+    std::vector<LodLevel> m_Levels;
+    BBox3f m_BBox;
+};
+
+// Pixels covered by one object unit at distance 1 along the view axis
+inline float projectedPixelsPerUnit(const glm::mat4& ProjMatrix, float viewportHeight) {
+    return ProjMatrix[1][1] * 0.5f * viewportHeight;
+}
+
+// LOD chains of the procedural shapes, one level per (discLat, discLong) / (nbi, nbe) pair, finest first
+LodMesh buildSphereLod(GLfloat radius, const std::vector<glm::ivec2>& tessellations);
+LodMesh buildToreLod(GLfloat ri, GLfloat re, const std::vector<glm::ivec2>& tessellations);
+
+// Distance from a point (in the tore's local space) to the ring built by Tore(ri, re, ...)
+float toreDistance(const glm::vec3& position, GLfloat ri, GLfloat re);
+
+}
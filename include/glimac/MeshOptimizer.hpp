@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+
+namespace glimac {
+
+// Build an indexed mesh from a triangle soup by merging identical vertices
+void indexTriangles(const std::vector<ShapeVertex>& triangles,
+                    std::vector<ShapeVertex>& vertices, std::vector<GLuint>& indices);
+
+// Reorder triangles to maximize post-transform vertex cache hits (Forsyth's linear-speed algorithm)
+void optimizeVertexCache(std::vector<GLuint>& indices, size_t vertexCount);
+
+// Reorder vertices in the order they are first referenced so fetches stay sequential
+void optimizeVertexFetch(std::vector<ShapeVertex>& vertices, std::vector<GLuint>& indices);
+
+// Both passes, in the order they must run
+inline void optimizeMesh(std::vector<ShapeVertex>& vertices, std::vector<GLuint>& indices) {
+    optimizeVertexCache(indices, vertices.size());
+    optimizeVertexFetch(vertices, indices);
+}
+
+}
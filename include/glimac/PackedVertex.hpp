@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+
+namespace glimac {
+
+// Compact version of ShapeVertex (16 bytes instead of 32):
+// - position: unorm16 x3 (+ padding), decoded with the mesh's VertexQuantization
+// - normal: GL_INT_2_10_10_10_REV, normalized
+// - texCoords: two half floats
+struct PackedShapeVertex {
+    GLushort position[4];
+    GLuint normal;
+    GLuint texCoords;
+};
+
+// Per-mesh position decoding: position = aPosition * scale + bias
+struct VertexQuantization {
+    glm::vec3 scale;
+    glm::vec3 bias;
+
+    VertexQuantization(): scale(1.f), bias(0.f) {
+    }
+};
+
+// Quantize vertices to the packed layout, quantization receives the decoding parameters
+std::vector<PackedShapeVertex> packShapeVertices(const ShapeVertex* vertices, GLsizei count,
+                                                 VertexQuantization& quantization);
+
+// Set up the position/normal/texCoords attributes for the buffer bound to GL_ARRAY_BUFFER,
+// either for ShapeVertex or for PackedShapeVertex
+void setShapeVertexAttribPointers(bool packed, GLuint position, GLuint normal, GLuint texCoords);
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+
+namespace glimac {
+
+// Frame profiler: named, nested scopes timed on the CPU with the high resolution clock and, for the
+// scopes marked gpu, on the GPU with GL_TIME_ELAPSED queries. Queries are pooled per frame in a ring
+// of FRAME_LATENCY frames and read FRAME_LATENCY frames later, only once available: reading never
+// waits for the GPU (a frame whose results are still pending is skipped). GL_TIME_ELAPSED queries
+// cannot nest, a gpu scope opened inside another one is only timed on the CPU.
+// Events go to a fixed size ring (the oldest are overwritten) that can be written as a Chrome trace
+// (chrome://tracing, ui.perfetto.dev). Names must be string literals: only the pointer is kept.
+// Disabled (the default), begin() and end() only test a flag.
+class Profiler {
+public:
+    static const GLuint FRAME_LATENCY = 4;
+    static const GLuint MAX_GPU_SCOPES = 32;     // per frame
+    static const size_t EVENT_CAPACITY = 1 << 16;
+
+    enum Track { CPU_TRACK = 0, GPU_TRACK = 1 };
+
+    struct Event {
+        const char* name;
+        // Nanoseconds since the profiler was first enabled. GPU queries only measure durations: a GPU event
+        // starts at the CPU start of its scope, or at the end of the previous GPU event if later
+        uint64_t start;
+        uint64_t duration; // nanoseconds
+        uint32_t frame;
+        uint8_t track;
+        uint8_t depth;     // nesting level on its track
+    };
+
+    // Needs a GL context: the queries are created when first enabled
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled() {
+        return m_Enabled;
+    }
+
+    // Start a new frame, collecting the GPU times of the frame FRAME_LATENCY frames back
+    static void newFrame() {
+        if(m_Enabled) {
+            startFrame();
+        }
+    }
+
+    static void begin(const char* name, bool gpu = false) {
+        if(m_Enabled) {
+            push(name, gpu);
+        }
+    }
+
+    static void end() {
+        if(m_Enabled) {
+            pop();
+        }
+    }
+
+    // Events recorded since the profiler was first enabled, the ring keeps the last EVENT_CAPACITY
+    static uint64_t getRecordedCount() {
+        return m_EventTotal;
+    }
+
+    // Events in the ring from the first-th recorded one (or the oldest still in the ring), oldest first
+    static std::vector<Event> getEvents(uint64_t first = 0);
+
+    // Wait for the GPU times of the frames still in flight and record them (end of a run)
+    static void flush();
+
+    // Chrome trace event format (JSON), one track for the CPU and one for the GPU
+    static bool writeChromeTrace(const std::string& path);
+
+    // Delete the queries, with the context still current
+    static void shutdown();
+
+private:
+    struct Scope {
+        const char* name;
+        uint64_t start;
+        GLint query; // index of the GPU query in the frame, -1 if not timed on the GPU
+    };
+
+    struct GpuFrame {
+        GLuint queries[MAX_GPU_SCOPES];
+        const char* names[MAX_GPU_SCOPES];
+        uint64_t cpuStarts[MAX_GPU_SCOPES];
+        GLuint count;
+        uint32_t frame;
+    };
+
+    static void startFrame();
+    static void push(const char* name, bool gpu);
+    static void pop();
+    static void resolveGpuFrame(GpuFrame& gpuFrame, bool wait);
+    static void record(const Event& event);
+    static uint64_t now();
+
+    static bool m_Enabled;
+    static bool m_Initialized;
+    static uint64_t m_Origin; // high resolution clock at the first setEnabled(true)
+    static uint32_t m_Frame;
+    static std::vector<Scope> m_Stack;
+    static GLint m_GpuScope;   // stack level of the scope timed on the GPU, -1 if none
+    static uint64_t m_GpuCursor; // end of the last GPU event, GPU events do not overlap
+    static GpuFrame m_GpuFrames[FRAME_LATENCY];
+    static std::vector<Event> m_Events;
+    static size_t m_EventHead;   // next event written
+    static size_t m_EventCount;
+    static uint64_t m_EventTotal;
+};
+
+// Profiler::begin() at construction and Profiler::end() at destruction
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name, bool gpu = false) {
+        Profiler::begin(name, gpu);
+    }
+
+    ~ProfileScope() {
+        Profiler::end();
+    }
+
+private:
+    ProfileScope(const ProfileScope&);
+    ProfileScope& operator =(const ProfileScope&);
+};
+
+}
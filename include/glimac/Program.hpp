@@ -1,8 +1,10 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <vector>
 #include "Shader.hpp"
 #include "FilePath.hpp"
+#include "GLState.hpp"
 
 namespace glimac {
 
@@ -12,7 +14,7 @@ public:
 	}
 
 	~Program() {
-		glDeleteProgram(m_nGLId);
+		GLState::deleteProgram(m_nGLId);
 	}
 
 	Program(Program&& rvalue): m_nGLId(rvalue.m_nGLId) {
@@ -35,10 +37,20 @@ public:
 
 	bool link();
 
+	// Must be called before link() for getBinary() to be usable
+	void setBinaryRetrievable() {
+		glProgramParameteri(m_nGLId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	// Load a binary previously returned by getBinary(); false if the driver rejects it
+	bool loadBinary(GLenum format, const void* data, GLsizei length);
+
+	std::vector<char> getBinary(GLenum& format) const;
+
 	const std::string getInfoLog() const;
 
 	void use() const {
-		glUseProgram(m_nGLId);
+		GLState::useProgram(m_nGLId);
 	}
 
 private:
@@ -49,7 +61,7 @@ private:
 };
 
 // Build a GLSL program from source code
-Program buildProgram(const GLchar* vsSrc, const GLchar* fsSrc);
+Program buildProgram(const GLchar* vsSrc, const GLchar* fsSrc, bool binaryRetrievable = false);
 
 // Load source code from files and build a GLSL program
 Program loadProgram(const FilePath& vsFile, const FilePath& fsFile);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+#include "Program.hpp"
+#include "FilePath.hpp"
+
+namespace glimac {
+
+// Registry of linked GLSL programs, keyed by a hash of their sources and defines.
+// Identical programs are built once and shared. When a cache directory is set and
+// the driver supports GL_ARB_get_program_binary, linked programs are also stored on
+// disk and reloaded with glProgramBinary on the next start, falling back to a
+// regular compilation when the binary is missing or rejected.
+class ProgramManager {
+private:
+    static std::unordered_map<uint64_t, std::unique_ptr<Program>> m_ProgramMap;
+    static FilePath m_CacheDirectory;
+
+    static std::unique_ptr<Program> loadCachedProgram(uint64_t hash);
+    static void storeCachedProgram(uint64_t hash, const Program& program);
+public:
+    // Enable the on-disk binary cache (created if it does not exist)
+    static void setCacheDirectory(const FilePath& directory);
+
+    // Defines are inserted right after the #version line of both shaders, e.g. "#define FOO 1\n"
+    static const Program& loadProgram(const FilePath& vsFile, const FilePath& fsFile, const std::string& defines = "");
+
+    // Delete every program, must be called while the GL context is still alive
+    static void clear();
+};
+
+// 64-bit FNV-1a hash
+uint64_t hashString(const std::string& str, uint64_t hash = 14695981039346656037ull);
+
+}
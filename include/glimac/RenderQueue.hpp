@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <type_traits>
+
+#include "common.hpp"
+
+namespace glimac {
+
+// Passes, executed in this order
+enum RenderPass {
+    RENDER_PASS_BACKGROUND = 0, // skybox, no depth test
+    RENDER_PASS_OPAQUE = 1
+};
+
+// Sets the per-draw state that is not part of the sort key (uniforms, attribute offsets...).
+// Called with the item's program and VAO bound; data points to the copy made by submit().
+typedef void (*RenderCallback)(const void* data);
+
+// One draw: state needed to sort and bind it, then the draw call parameters
+struct RenderItem {
+    uint64_t key;
+    GLuint program;
+    GLuint vao;
+    GLenum textureTarget; // 0 if the draw needs no particular texture
+    GLuint texture;
+    GLuint textureUnit;
+    GLboolean depthTest;
+    GLenum mode;
+    GLsizei count;
+    GLenum indexType;     // 0 for glDrawArrays
+    GLintptr first;       // first vertex, or byte offset in the index buffer
+    GLint baseVertex;     // added to every index (meshes of a GeometryArena)
+    GLsizei instanceCount; // 0 for a non-instanced draw
+    GLuint indirectBuffer; // non-zero: glMultiDrawElementsIndirect of count commands read at byte offset first
+    RenderCallback callback;
+    size_t dataOffset;
+    const char* stage;    // profiler stage of the draw (string literal), set by submit() from the queue's stage
+
+    RenderItem(): key(0), program(0), vao(0), textureTarget(0), texture(0), textureUnit(0), depthTest(GL_TRUE),
+        mode(GL_TRIANGLES), count(0), indexType(GL_UNSIGNED_INT), first(0), baseVertex(0), instanceCount(0), indirectBuffer(0),
+        callback(nullptr), dataOffset(0), stage(nullptr) {
+    }
+};
+
+// Key layout, most significant first: pass (4 bits) | program (12) | VAO (12) | texture (12) | depth (24).
+// GL names are truncated to their field: a collision only costs a redundant bind, not a wrong one.
+// depth is the normalized view distance in [0, 1], near first.
+uint64_t makeSortKey(RenderPass pass, GLuint program, GLuint vao, GLuint texture, float depth);
+
+// Sort depth of a view-space z for a perspective ProjMatrix: 0 at the near plane, 1 at the far plane
+inline float sortDepth(const glm::mat4& ProjMatrix, float viewZ) {
+    float zNear = ProjMatrix[3][2] / (ProjMatrix[2][2] - 1.f);
+    float zFar = ProjMatrix[3][2] / (ProjMatrix[2][2] + 1.f);
+    return (-viewZ - zNear) / (zFar - zNear);
+}
+
+// Draws are submitted in any order, sorted by key once per frame and executed through GLState
+// so that only the program/VAO/texture/depth test changes between consecutive items are issued.
+// Each item carries the stage it was submitted under (setStage()): at execution, every run of consecutive
+// items of the same pass and stage is a GPU scope of the Profiler named after the stage (after the pass
+// for untagged items), so the GPU time of a stage is the sum of its runs in the frame.
+class RenderQueue {
+public:
+    RenderQueue(): m_Stage(nullptr) {
+    }
+
+    // Stage of the items submitted from now on (a string literal), until the next call or clear()
+    void setStage(const char* stage) {
+        m_Stage = stage;
+    }
+
+    // Fills item.key from its pass, program, VAO, texture and depth
+    void submit(RenderItem item, RenderPass pass, float depth);
+
+    // Same, with a copy of data handed to item.callback at execution
+    template<typename T>
+    void submit(RenderItem item, RenderPass pass, float depth, RenderCallback callback, const T& data) {
+        // The copy lives in a byte buffer that may be reallocated and is never destroyed
+        static_assert(std::is_trivially_destructible<T>::value, "callback data must be plain data");
+        item.callback = callback;
+        item.dataOffset = allocateData(sizeof(T));
+        new (&m_Data[item.dataOffset]) T(data);
+        submit(item, pass, depth);
+    }
+
+    // Radix sort of the items by key (stable)
+    void sort();
+
+    // Issue the sorted draws; the queue keeps its items until clear()
+    void execute();
+
+    void clear();
+
+    size_t size() const {
+        return m_Items.size();
+    }
+
+private:
+    size_t allocateData(size_t size);
+
+    std::vector<RenderItem> m_Items;
+    std::vector<uint32_t> m_Order, m_Scratch;
+    std::vector<char> m_Data;
+    const char* m_Stage;
+};
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <GL/glew.h>
 #include <SDL/SDL.h>
 #include "glm.hpp"
 
@@ -10,8 +11,35 @@ class SDLWindowManager {
 public:
     SDLWindowManager(uint32_t width, uint32_t height, const char* title);
 
+    // headless: no window, an EGL context (Mesa surfaceless platform when available) rendering into an
+    // offscreen framebuffer of width x height, bound as the default draw target. GLEW is initialized here
+    // since the framebuffer needs it; there are no events in this mode.
+    SDLWindowManager(uint32_t width, uint32_t height, const char* title, bool headless);
+
     ~SDLWindowManager();
 
+    // False if the window or the context could not be created
+    bool isValid() const {
+        return m_Valid;
+    }
+
+    bool isHeadless() const {
+        return m_Headless;
+    }
+
+    // Framebuffer standing for the window: 0, or the offscreen framebuffer in headless mode
+    GLuint getFramebuffer() const {
+        return m_Framebuffer;
+    }
+
+    uint32_t getWidth() const {
+        return m_Width;
+    }
+
+    uint32_t getHeight() const {
+        return m_Height;
+    }
+
     bool pollEvent(SDL_Event& e);
 
     bool isKeyPressed(SDLKey key) const;
@@ -25,6 +53,24 @@ public:
 
     // Return the time in seconds
     float getTime() const;
+
+private:
+    SDLWindowManager(const SDLWindowManager&);
+    SDLWindowManager& operator =(const SDLWindowManager&);
+
+    void openWindow(const char* title);
+    void createHeadlessContext();
+
+    uint32_t m_Width;
+    uint32_t m_Height;
+    bool m_Headless;
+    bool m_Valid;
+    // Headless mode
+    void* m_Display; // EGLDisplay
+    void* m_Context; // EGLContext
+    GLuint m_Framebuffer;
+    GLuint m_ColorBuffer;
+    GLuint m_DepthBuffer;
 };
 
 }
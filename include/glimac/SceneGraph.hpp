@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "common.hpp"
+
+namespace glimac {
+
+typedef GLuint SceneNode;
+const SceneNode NO_PARENT = ~0u;
+
+// Flat transform hierarchy. Nodes live in parallel arrays in topological order (a parent is always
+// added before its children), so update() is a single linear pass where the world matrix of a node
+// is recomputed only if its local transform or one of its ancestors changed.
+//
+// The local matrix of a node is  Orbit(time) * Translate * Scale * Tilt * Spin(time):
+// - translation, scale and tilt are fixed and cached together as one static matrix,
+// - orbit and spin are rotations at a constant speed (radians per second), left out when the speed is 0.
+// A node with no animation and no changed parent keeps its cached matrices from frame to frame.
+//
+// The matrices to recompute are gathered first, then composed in batches (see TransformBatch): the
+// orbit and spin rotations of every animated node, their products with the static matrices, and the
+// world matrices one depth of the hierarchy at a time (the nodes of a depth only read their parents').
+class SceneGraph {
+public:
+    SceneGraph(): m_Time(0.), m_UpdatedCount(0) {
+    }
+
+    // Append a node; parent must be NO_PARENT or an existing node
+    SceneNode addNode(SceneNode parent, const glm::vec3& translation, const glm::vec3& scale = glm::vec3(1.f));
+
+    // Static part
+    void setTranslation(SceneNode node, const glm::vec3& translation);
+    void setScale(SceneNode node, const glm::vec3& scale);
+    void setTilt(SceneNode node, float angle, const glm::vec3& axis);
+
+    // Animated part: rotation around axis by time * speed, before (orbit) or after (spin) the static part
+    void setOrbit(SceneNode node, const glm::vec3& axis, float speed);
+    void setSpin(SceneNode node, const glm::vec3& axis, float speed);
+
+    // Recompute the local matrices of the dirty or animated nodes and the world matrices of their subtrees.
+    // Angles are reduced modulo 2 pi in double precision, so they stay accurate however large time gets
+    void update(double time);
+
+    const glm::mat4& getWorldMatrix(SceneNode node) const {
+        return m_WorldMatrices[node];
+    }
+
+    const glm::mat4& getLocalMatrix(SceneNode node) const {
+        return m_LocalMatrices[node];
+    }
+
+    SceneNode getParent(SceneNode node) const {
+        return m_Parents[node];
+    }
+
+    GLsizei getNodeCount() const {
+        return m_Parents.size();
+    }
+
+    // Number of world matrices recomputed by the last update()
+    GLsizei getUpdatedCount() const {
+        return m_UpdatedCount;
+    }
+
+private:
+    enum Flags {
+        STATIC_DIRTY = 1,  // translation, scale or tilt changed
+        LOCAL_DIRTY = 2,   // orbit or spin changed
+        WORLD_CHANGED = 4  // world matrix recomputed by the current update()
+    };
+
+    std::vector<SceneNode> m_Parents;
+    std::vector<GLuint> m_Depths; // 0 for the roots
+    std::vector<glm::vec3> m_Translations;
+    std::vector<glm::vec3> m_Scales;
+    std::vector<glm::vec4> m_Tilts; // axis, angle
+    std::vector<glm::vec4> m_Orbits; // axis, speed
+    std::vector<glm::vec4> m_Spins; // axis, speed
+    std::vector<glm::mat4> m_StaticMatrices; // Translate * Scale * Tilt
+    std::vector<glm::mat4> m_LocalMatrices;
+    std::vector<glm::mat4> m_WorldMatrices;
+    std::vector<std::uint8_t> m_Flags;
+    // Scratch arrays of update(), kept to avoid reallocating every frame
+    std::vector<SceneNode> m_LocalNodes; // nodes whose local matrix is recomputed
+    std::vector<glm::vec4> m_OrbitAngles, m_SpinAngles; // axis, angle
+    std::vector<glm::mat4> m_OrbitRotations, m_SpinRotations, m_Products;
+    std::vector<SceneNode> m_WorldNodes; // nodes whose world matrix is recomputed
+    std::vector<SceneNode> m_SortedNodes, m_WorldParents; // the same sorted by depth, and their parents
+    std::vector<GLuint> m_DepthCounts, m_DepthOffsets;
+    std::vector<GLuint> m_Sequence; // 0, 1, 2...
+    double m_Time;
+    GLsizei m_UpdatedCount;
+};
+
+}
@@ -46,6 +46,9 @@ private:
 	GLuint m_nGLId;
 };
 
+// Read the source code of a shader file
+std::string loadShaderSource(const FilePath& filepath);
+
 // Load a shader (but does not compile it)
 Shader loadShader(GLenum type, const FilePath& filepath);
 
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "glm.hpp"
+#include "SceneGraph.hpp"
+#include "TripleBuffer.hpp"
+
+namespace glimac {
+
+// Simulation time as a number of fixed steps: exact in 64 bits, converted to seconds in double precision
+class SimulationClock {
+public:
+    explicit SimulationClock(double step): m_Tick(0), m_Step(step) {
+    }
+
+    void advance() {
+        ++m_Tick;
+    }
+
+    uint64_t getTick() const {
+        return m_Tick;
+    }
+
+    double getStep() const {
+        return m_Step;
+    }
+
+    double getTime() const {
+        return m_Tick * m_Step;
+    }
+
+private:
+    uint64_t m_Tick;
+    double m_Step;
+};
+
+// What the simulation hands to the renderer after its steps: the world matrices of every scene node
+// at the last two steps, so that the renderer can interpolate between them
+struct SimulationState {
+    uint64_t tick;
+    double time;     // simulation time of current
+    double step;
+    double timeScale;
+    std::chrono::steady_clock::time_point realTime; // real time corresponding to current
+    std::vector<glm::mat4> previous; // at time - step
+    std::vector<glm::mat4> current;  // at time
+};
+
+// Fixed-step update of a SceneGraph on its own thread. Real time, multiplied by the time scale, is
+// accumulated and consumed in steps of a fixed length; after each batch of steps the last two states
+// are published through a TripleBuffer. The renderer never waits for the simulation nor the other way
+// around: a slow frame does not slow the simulation down, a slow step only delays the next state.
+// Once start() is called the scene graph belongs to the simulation thread until stop().
+class Simulation {
+public:
+    // Steps caught up at most per wake-up; beyond that simulation time slips instead of spiralling
+    static const unsigned int MAX_CATCH_UP_STEPS = 8;
+
+    explicit Simulation(SceneGraph& scene, double step = 1. / 120.);
+
+    ~Simulation();
+
+    void start();
+
+    void stop();
+
+    // Simulated seconds per real second (0 pauses), thread safe
+    void setTimeScale(double timeScale) {
+        m_TimeScale.store(timeScale, std::memory_order_relaxed);
+    }
+
+    double getTimeScale() const {
+        return m_TimeScale.load(std::memory_order_relaxed);
+    }
+
+    // Renderer side: take the latest state and write the world matrices of the nodes interpolated for the
+    // current real time, one step behind the simulation. Returns the simulation time they correspond to.
+    double interpolate(std::vector<glm::mat4>& worldMatrices);
+
+private:
+    Simulation(const Simulation&);
+    Simulation& operator =(const Simulation&);
+
+    void run();
+    void copyWorldMatrices(std::vector<glm::mat4>& matrices) const;
+
+    SceneGraph& m_Scene;
+    SimulationClock m_Clock;
+    std::atomic<double> m_TimeScale;
+    std::atomic<bool> m_Running;
+    std::thread m_Thread;
+    TripleBuffer<SimulationState> m_States;
+};
+
+}
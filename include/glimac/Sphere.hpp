@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "common.hpp"
+#include "PackedVertex.hpp"
 
 #include <c3ga/Mvec.hpp>
 
@@ -29,6 +30,15 @@ namespace glimac {
             // Renvoit le nombre de vertex
             GLsizei getVertexCount() const;
 
+            // Renvoit le pointeur vers les indices (triangles)
+            const GLuint* getIndexPointer() const;
+
+            // Renvoit le nombre d'indices
+            GLsizei getIndexCount() const;
+
+            // Renvoit les sommets au format compact (memes indices)
+            std::vector<PackedShapeVertex> getPackedData(VertexQuantization &quantization) const;
+
             c3ga::Mvec<double> sphere(float Rsphere);
             c3ga::Mvec<double> getSphere();
             void setSphere(c3ga::Mvec<double> sph);
@@ -38,8 +48,9 @@ namespace glimac {
         	c3ga::Mvec<double> s;
         	std::list<c3ga::Mvec<double>> coordsphere;
             std::vector<ShapeVertex> vertices;
+            std::vector<GLuint> indices;
             c3ga::Mvec<GLfloat> radiusVector;
-            GLsizei vertexCount; // Nombre de sommets
+            GLsizei vertexCount; // Nombre de sommets distincts
             GLsizei latitude;
             GLsizei longitude;
       
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+
+namespace glimac {
+
+// Buffer for data rewritten every frame (instance transforms, per-frame uniforms...), split into
+// frameCount regions used in turn. Each region is protected by a fence placed after the draws of its
+// frame, so writing into it never waits on the GPU nor makes the driver copy or orphan the buffer.
+// With GL 4.4 / ARB_buffer_storage the buffer is mapped once (persistent, coherent), otherwise the
+// current region is mapped unsynchronized at beginFrame() and unmapped by unmap().
+//
+// Frame loop:
+//   beginFrame();  allocate()... write...;  unmap();  draws;  endFrame();
+//
+// Allocations are suballocated linearly from the current region. When a frame needs more than a
+// region, the allocations that do not fit return a null pointer and the buffer grows at the next
+// beginFrame().
+class StreamBuffer {
+public:
+    struct Allocation {
+        void* data;      // where to write, nullptr if the region is full
+        GLintptr offset; // offset from the start of getBuffer(), for attribute pointers and bind ranges
+    };
+
+    explicit StreamBuffer(GLsizeiptr frameSize, GLuint frameCount = 3);
+
+    ~StreamBuffer();
+
+    // Switch to the next region, waiting for the GPU to be done with it
+    void beginFrame();
+
+    Allocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+
+    // Make the writes of the frame visible to the GPU, before the first draw reading them
+    void unmap();
+
+    // Protect the region of the frame until the GPU has executed the draws submitted so far
+    void endFrame();
+
+    GLuint getBuffer() const {
+        return m_Buffer;
+    }
+
+    GLsizeiptr getFrameSize() const {
+        return m_FrameSize;
+    }
+
+    // Bytes requested during the current frame
+    GLsizeiptr getFrameUsage() const {
+        return m_Head;
+    }
+
+    bool isPersistent() const {
+        return m_Persistent;
+    }
+
+private:
+    StreamBuffer(const StreamBuffer&);
+    StreamBuffer& operator =(const StreamBuffer&);
+
+    void create();
+    void destroy();
+    void waitFence(GLuint frame);
+
+    GLuint m_Buffer;
+    GLsizeiptr m_FrameSize;
+    GLuint m_FrameCount;
+    GLuint m_Frame;
+    GLsizeiptr m_Head;
+    bool m_Persistent;
+    char* m_PersistentData; // whole buffer, persistent mapping only
+    char* m_Region;         // current region, nullptr when not mapped
+    std::vector<GLsync> m_Fences;
+};
+
+}
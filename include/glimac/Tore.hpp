@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "common.hpp"
+#include "PackedVertex.hpp"
 
 #include <c3ga/Mvec.hpp>
 
@@ -28,9 +29,19 @@ namespace glimac {
             // Renvoit le nombre de vertex
             GLsizei getVertexCount() const;
 
+            // Renvoit le pointeur vers les indices (triangles)
+            const GLuint* getIndexPointer() const;
+
+            // Renvoit le nombre d'indices
+            GLsizei getIndexCount() const;
+
+            // Renvoit les sommets au format compact (memes indices)
+            std::vector<PackedShapeVertex> getPackedData(VertexQuantization &quantization) const;
+
         private:
             std::vector<ShapeVertex> vertices;
-            GLsizei vertexCount; // Nombre de sommets
+            std::vector<GLuint> indices;
+            GLsizei vertexCount; // Nombre de sommets distincts
             GLsizei latitude;
             GLsizei longitude;
       
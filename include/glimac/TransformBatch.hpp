@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+#include "common.hpp"
+#include "Frustum.hpp"
+
+namespace glimac {
+
+// Inverse of a similarity transform (rotation, uniform scale s and translation t), in closed form:
+// the 3x3 part is R^T / s, so the inverse is [M3^T / s^2 | -M3^T t / s^2]. No general 4x4 inverse needed.
+inline glm::mat4 similarityInverse(const glm::mat4& M) {
+    glm::mat3 inv = glm::transpose(glm::mat3(M)) / glm::dot(glm::vec3(M[0]), glm::vec3(M[0]));
+    glm::mat4 result(inv);
+    result[3] = glm::vec4(-(inv * glm::vec3(M[3])), 1.f);
+    return result;
+}
+
+// Blend of two transforms made of a rotation, a scale and a translation (as produced by a SceneGraph):
+// translation and scale are interpolated linearly, the rotation along the shortest arc (slerp), so the
+// result stays rigid where a linear blend of the matrices would shrink it
+glm::mat4 interpolateSimilarity(const glm::mat4& a, const glm::mat4& b, float t);
+
+// Rotation matrices of count (axis, angle) pairs, by Rodrigues' formula R = cI + s[k]x + (1 - c)kk^T.
+// Sines and cosines are computed first into arrays, the matrices are then built 4 at a time (structure
+// of arrays). Axes need not be normalized; an angle of 0 gives the identity.
+void rotationMatrices(const glm::vec4* axisAngles, size_t count, glm::mat4* rotations);
+
+// Batch product of affine matrices (last row 0 0 0 1): results[resultIndices[k]] = lefts[leftIndices[k]] *
+// rights[rightIndices[k]] for k < count. Operands are gathered 4 at a time and transposed into SSE
+// registers. results may be lefts or rights as long as no product reads a matrix written by the same call.
+void multiplyAffine(const glm::mat4* lefts, const GLuint* leftIndices, const glm::mat4* rights, const GLuint* rightIndices,
+                    size_t count, glm::mat4* results, const GLuint* resultIndices);
+
+// Batch transform of the bounding sphere (center, radius) of a mesh by count model matrices.
+// Matrices are read every stride bytes so they can sit inside per instance structures. Each sphere
+// is written at the same index of spheres (resized to count) and scales receives the largest axis
+// scale of each matrix. Matrices are transposed 4 at a time into SSE registers (structure of arrays).
+void transformBoundingSpheres(const glm::mat4* matrices, size_t stride, size_t count,
+                              const glm::vec3& center, float radius, BoundingSpheres& spheres, float* scales);
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+
+namespace glimac {
+
+// Lock-free handoff of a state from one writer thread to one reader thread. Three copies: the writer
+// fills its own, then swaps it with the shared one; the reader swaps its own with the shared one when
+// it holds a newer state. Neither side ever waits: the writer may publish several states in a row
+// (the reader then only sees the latest) and the reader keeps its copy as long as nothing newer came.
+template<typename T>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const T& initial = T()):
+        m_Write(0), m_Shared(1), m_Read(2) {
+        for(T& slot : m_Slots) {
+            slot = initial;
+        }
+    }
+
+    // Writer side: the copy to fill, owned by the writer until publish()
+    T& getWriteBuffer() {
+        return m_Slots[m_Write];
+    }
+
+    // Writer side: hand the filled copy over and take the shared one (older, or never read) to fill next
+    void publish() {
+        m_Write = m_Shared.exchange(m_Write | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side: take the latest published copy if there is one; true if the read copy changed
+    bool update() {
+        if(!(m_Shared.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        m_Read = m_Shared.exchange(m_Read, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // Reader side: the copy owned by the reader, valid until the next update()
+    const T& getReadBuffer() const {
+        return m_Slots[m_Read];
+    }
+
+private:
+    TripleBuffer(const TripleBuffer&);
+    TripleBuffer& operator =(const TripleBuffer&);
+
+    static const unsigned int INDEX_MASK = 3;
+    static const unsigned int FRESH = 4; // set on the shared index when it holds a state not read yet
+
+    T m_Slots[3];
+    unsigned int m_Write; // writer thread only
+    // Padding keeps the shared index off the cache lines of the indices private to each thread
+    char m_WritePadding[64];
+    std::atomic<unsigned int> m_Shared;
+    char m_SharedPadding[64];
+    unsigned int m_Read; // reader thread only
+};
+
+}
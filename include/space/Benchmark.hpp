@@ -0,0 +1,110 @@
+#ifndef BENCHMARK
+#define BENCHMARK
+    #include <vector>
+    #include <string>
+    #include <chrono>
+    #include <map>
+    #include <cstdint>
+    #include <glimac/glm.hpp>
+
+    using namespace glm;
+
+    /*
+     * Trajectoire fermee de la camera : spline de Catmull-Rom passant par des points de controle,
+     * la camera regardant toujours une meme cible.
+     */
+    class CameraPath {
+        public :
+            /*
+             * Constructeur.
+             * @param points : les points de controle, parcourus en boucle (au moins 2).
+             * @param target : le point regarde par la camera.
+             */
+            CameraPath(const std::vector<glm::vec3> &points, const glm::vec3 &target);
+
+            /*
+             * Renvoie la position de la camera.
+             * @param t : l'avancement sur la boucle, dans [0, 1].
+             */
+            glm::vec3 getPosition(float t) const;
+
+            /*
+             * Renvoie la matrice de vue de la camera.
+             * @param t : l'avancement sur la boucle, dans [0, 1].
+             */
+            glm::mat4 getViewMatrix(float t) const;
+
+        private :
+            std::vector<glm::vec3> points;
+            glm::vec3 target;
+    };
+
+    /*
+     * Mode benchmark : temps de simulation fixe par frame et camera scriptee, pour des mesures reproductibles.
+     * Les premieres frames (chauffe : caches, compilation des shaders par le pilote) ne sont pas mesurees.
+     * Les temps des etapes sont ceux du Profiler, qui doit etre active : ses evenements sont cumules a chaque frame,
+     * le rapport ne depend donc pas de la taille de son anneau.
+     */
+    class Benchmark {
+        public :
+            /*
+             * Constructeur.
+             * @param frameCount : le nombre de frames mesurees.
+             * @param warmupFrames : le nombre de frames jouees avant la mesure.
+             * @param timeStep : le temps de simulation d'une frame, en secondes.
+             */
+            Benchmark(unsigned int frameCount, unsigned int warmupFrames = 30, float timeStep = 1.f / 60.f);
+
+            /*
+             * Renvoie le nombre total de frames a jouer (chauffe comprise).
+             */
+            unsigned int getTotalFrames() const;
+
+            /*
+             * Renvoie le temps de simulation d'une frame.
+             * @param frame : l'indice de la frame, a partir de 0.
+             */
+            double getTime(unsigned int frame) const;
+
+            /*
+             * Renvoie la matrice de vue de la camera scriptee (immobile pendant la chauffe).
+             * @param frame : l'indice de la frame, a partir de 0.
+             */
+            glm::mat4 getViewMatrix(unsigned int frame) const;
+
+            /*
+             * Marque la fin d'une frame (apres l'echange des buffers) : le temps ecoule depuis la precedente est mesure
+             * et les temps des etapes enregistres par le Profiler depuis sont cumules.
+             */
+            void endFrame();
+
+            /*
+             * Ecrit le rapport JSON : moyenne, p50, p95 et p99 des temps de frame et de chaque etape CPU et GPU.
+             * Attend les temps GPU des dernieres frames. Un resume est aussi affiche sur la sortie standard, et un
+             * avertissement sur la sortie d'erreur pour chaque etape qui n'a pas ete mesuree sur toutes les frames.
+             * @param path : le fichier ecrit.
+             */
+            bool writeReport(const std::string &path);
+
+        private :
+            typedef std::chrono::high_resolution_clock Clock;
+
+            CameraPath path;
+            unsigned int frameCount;
+            unsigned int warmupFrames;
+            float timeStep;
+            unsigned int endedFrames;
+            Clock::time_point lastFrameEnd;
+            std::vector<double> frameTimes; // en millisecondes, frames mesurees seulement
+            uint64_t eventCursor; // evenements du Profiler deja cumules
+            uint64_t lostEvents; // evenements ecrases dans l'anneau du Profiler avant d'etre cumules
+            // Temps de chaque etape par frame mesuree, en millisecondes, pour les pistes CPU et GPU
+            std::map<std::string, std::map<uint32_t, double>> stageTimes[2];
+
+            /*
+             * Cumule les evenements enregistres par le Profiler depuis le dernier appel.
+             */
+            void collectEvents();
+    };
+
+#endif // BENCHMARK
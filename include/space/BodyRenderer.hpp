@@ -0,0 +1,108 @@
+#ifndef BODYRENDERER
+#define BODYRENDERER
+    #include <vector>
+    #include <GL/glew.h>
+    #include <glimac/common.hpp>
+    #include <glimac/PackedVertex.hpp>
+    #include <glimac/GeometryArena.hpp>
+    #include <glimac/LodMesh.hpp>
+    #include <glimac/Frustum.hpp>
+    #include <glimac/TransformBatch.hpp>
+    #include <glimac/RenderQueue.hpp>
+    #include <glimac/CameraUniforms.hpp>
+    #include <glimac/StreamBuffer.hpp>
+    #include <space/Texture.hpp>
+
+    using namespace glimac;
+    using namespace glm;
+
+    /*
+     * Donnees propres a chaque instance d'astre (une par planete ou satellite).
+     * La vue et la projection viennent du bloc Camera (voir CameraUniformBuffer).
+     */
+    struct BodyInstance {
+        glm::mat4 ModelMatrix;
+        GLfloat layer; // couche de la texture array
+    };
+
+    class BodyRenderer {
+        public :
+            /*
+             * Constructeur du renderer instancie.
+             * @param geometry : l'arena contenant la sphere (deja envoyee au GPU).
+             * @param mesh : la place de la sphere dans l'arena.
+             * @param lod : les niveaux de detail de la sphere (doit survivre au renderer).
+             * @param stream : le buffer ou les instances sont ecrites a chaque frame (doit survivre au renderer).
+             */
+            BodyRenderer(const GeometryArena &geometry, const MeshHandle &mesh, const LodMesh &lod, StreamBuffer &stream);
+
+            /*
+             * Destructeur
+             */
+            ~BodyRenderer();
+
+            /*
+             * Regle le choix du niveau de detail.
+             * @param viewportHeight : la hauteur du viewport en pixels.
+             * @param maxPixelError : l'erreur geometrique tolere a l'ecran, en pixels.
+             */
+            void setLodParameters(GLfloat viewportHeight, GLfloat maxPixelError);
+
+            /*
+             * Vide la liste des instances (a appeler au debut de chaque frame).
+             */
+            void clear();
+
+            /*
+             * Ajoute un astre a dessiner.
+             * @param ModelMatrix : la matrice Model de l'astre (repere du monde).
+             * @param layer : la couche de la texture array a utiliser.
+             */
+            void addInstance(const glm::mat4 &ModelMatrix, GLfloat layer);
+
+            /*
+             * Elimine les astres hors du champ de la camera, ecrit les autres dans le stream buffer et ajoute
+             * a la file un dessin instancie par niveau de detail utilise (choisi d'apres la taille
+             * projetee de chaque astre).
+             * @param queue : la file de rendu de la frame.
+             * @param program : le programme instancie.
+             * @param textureArray : la texture array des astres.
+             * @param camera : la vue et la projection de la frame.
+             */
+            void submit(RenderQueue &queue, const InstancedTexProgram &program, GLuint textureArray, const CameraUniforms &camera);
+
+            /*
+             * Renvoie le nombre d'instances visibles au dernier draw.
+             */
+            GLsizei getVisibleCount() const;
+
+        private :
+            BodyRenderer(const BodyRenderer&);
+            BodyRenderer& operator =(const BodyRenderer&);
+
+            // Pointe les attributs d'instance du VAO lie a partir de l'octet offset du VBO d'instances
+            void setInstanceAttribPointers(GLintptr offset) const;
+
+            // Etat propre a un niveau, applique par la file de rendu juste avant le dessin
+            struct LevelDrawData {
+                const BodyRenderer *renderer;
+                const InstancedTexProgram *program;
+                GLintptr offset;
+            };
+            static void setLevelState(const void *data);
+
+            std::vector<BodyInstance> instances;
+            BoundingSpheres spheres; // spheres englobantes des instances dans le repere du monde
+            std::vector<GLfloat> scales; // plus grand facteur d'echelle de chaque instance
+            std::vector<GLuint> visible; // indices des instances dans le champ
+            std::vector<BodyInstance> sortedInstances; // instances visibles regroupees par niveau
+            std::vector<GLsizei> levelCounts;
+            const LodMesh &lod;
+            GLfloat viewportHeight;
+            GLfloat maxPixelError;
+            MeshHandle mesh;
+            StreamBuffer &stream;
+            GLuint vao;
+    };
+
+#endif // BODYRENDERER
@@ -0,0 +1,86 @@
+#ifndef DYNAMICRESOLUTION
+#define DYNAMICRESOLUTION
+    #include <GL/glew.h>
+    #include <glimac/common.hpp>
+    #include <space/Texture.hpp>
+
+    using namespace glimac;
+    using namespace glm;
+
+    /*
+     * Resolution dynamique : la scene est rendue dans un framebuffer hors ecran, dans une zone dont l'echelle
+     * suit le temps GPU mesure pour tendre vers un budget, puis agrandie a la taille de sortie avec un
+     * filtre de nettete. Le framebuffer est alloue une fois a l'echelle maximale : changer d'echelle ne
+     * change que le viewport (et le scissor) du rendu.
+     * Le temps GPU de la scene est mesure par deux requetes GL_TIMESTAMP par frame (compatibles avec les
+     * requetes GL_TIME_ELAPSED du Profiler), lues FRAME_LATENCY frames plus tard et seulement si disponibles.
+     */
+    class DynamicResolution {
+        public :
+            static const GLuint FRAME_LATENCY = 4;
+
+            /*
+             * Constructeur.
+             * @param width, height : la taille de sortie.
+             * @param budget : le temps GPU vise pour la scene, en millisecondes.
+             * @param minScale, maxScale : les bornes de l'echelle de rendu (par axe).
+             */
+            DynamicResolution(GLsizei width, GLsizei height, GLfloat budget, GLfloat minScale = 0.5f, GLfloat maxScale = 1.f);
+
+            /*
+             * Destructeur
+             */
+            ~DynamicResolution();
+
+            /*
+             * Ajuste l'echelle d'apres la mesure la plus recente, puis lie le framebuffer de la scene
+             * limite a la zone de rendu. A appeler avant d'effacer et de dessiner la scene.
+             */
+            void beginScene();
+
+            /*
+             * Termine la mesure de la scene et l'agrandit dans le framebuffer de sortie (toute sa surface).
+             * @param framebuffer : le framebuffer de sortie (0 pour la fenetre).
+             * @param program : le programme d'agrandissement.
+             */
+            void endScene(GLuint framebuffer, const UpscaleProgram &program);
+
+            /*
+             * Renvoie l'echelle de rendu courante.
+             */
+            GLfloat getScale() const;
+
+            /*
+             * Renvoie la taille de la zone de rendu, en pixels.
+             */
+            GLsizei getRenderWidth() const;
+            GLsizei getRenderHeight() const;
+
+            /*
+             * Renvoie le dernier temps GPU mesure pour la scene, en millisecondes (0 avant la premiere mesure).
+             */
+            GLfloat getSceneTime() const;
+
+        private :
+            DynamicResolution(const DynamicResolution&);
+            DynamicResolution& operator =(const DynamicResolution&);
+
+            // Lit la mesure la plus ancienne de l'anneau et corrige l'echelle
+            void updateScale();
+
+            GLsizei width, height;           // taille de sortie
+            GLsizei textureWidth, textureHeight; // taille du framebuffer de la scene (echelle maximale)
+            GLfloat budget;
+            GLfloat minScale, maxScale;
+            GLfloat scale;
+            GLfloat sceneTime;
+            GLuint framebuffer;
+            GLuint colorTexture;
+            GLuint depthBuffer;
+            GLuint vao; // vide : le triangle de l'ecran est calcule dans le vertex shader
+            GLuint queries[FRAME_LATENCY][2]; // debut et fin de la scene
+            bool pending[FRAME_LATENCY];
+            GLuint frame;
+    };
+
+#endif // DYNAMICRESOLUTION
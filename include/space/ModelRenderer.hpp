@@ -0,0 +1,105 @@
+#ifndef MODELRENDERER
+#define MODELRENDERER
+    #include <vector>
+    #include <GL/glew.h>
+    #include <glimac/common.hpp>
+    #include <glimac/BBox.hpp>
+    #include <glimac/Geometry.hpp>
+    #include <glimac/Frustum.hpp>
+    #include <glimac/RenderQueue.hpp>
+    #include <glimac/CameraUniforms.hpp>
+    #include <space/Texture.hpp>
+
+    using namespace glimac;
+    using namespace glm;
+
+    // Point de liaison du shader storage buffer des materiaux (voir model.fs.glsl)
+    const GLuint MATERIAL_STORAGE_BINDING = 1;
+
+    /*
+     * Materiau tel que lu par le shader (layout std430, uniquement des vec4).
+     */
+    struct ModelMaterial {
+        glm::vec4 diffuse;  // Kd, opacite
+        glm::vec4 specular; // Ks, brillance
+        glm::vec4 emission; // Le
+    };
+
+    /*
+     * Commande lue par glMultiDrawElementsIndirect.
+     */
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    class ModelRenderer {
+        public :
+            /*
+             * Envoie une seule fois au GPU les sommets, les indices et les materiaux d'un modele OBJ,
+             * et prepare une commande indirecte par sous-maillage, regroupees par materiau.
+             * Necessite OpenGL 4.3 (multi draw indirect et shader storage buffers).
+             * @param geometry : le modele charge par Geometry::loadOBJ.
+             */
+            ModelRenderer(const Geometry &geometry);
+
+            /*
+             * Destructeur
+             */
+            ~ModelRenderer();
+
+            /*
+             * Ajoute le modele a la file de rendu s'il est dans le champ : un seul
+             * glMultiDrawElementsIndirect par materiau.
+             * @param queue : la file de rendu de la frame.
+             * @param program : le programme des modeles.
+             * @param ModelMatrix : la matrice Model du modele (repere du monde).
+             * @param camera : la vue et la projection de la frame.
+             * @param frustum : le champ de la camera dans le repere du monde.
+             */
+            void submit(RenderQueue &queue, const ModelProgram &program, const glm::mat4 &ModelMatrix,
+                        const CameraUniforms &camera, const Frustum &frustum);
+
+            /*
+             * Renvoie la boite englobante du modele (repere du modele).
+             */
+            const BBox3f& getBoundingBox() const;
+
+            /*
+             * Renvoie le nombre d'appels de dessin par frame (un par materiau utilise).
+             */
+            GLsizei getDrawCount() const;
+
+        private :
+            ModelRenderer(const ModelRenderer&);
+            ModelRenderer& operator =(const ModelRenderer&);
+
+            // Sous-maillages d'un meme materiau : commandes [first, first + count[ du buffer indirect
+            struct Bucket {
+                GLint material;
+                GLsizei first;
+                GLsizei count;
+            };
+
+            // Etat propre a un materiau, applique par la file de rendu juste avant le dessin
+            struct BucketDrawData {
+                const ModelProgram *program;
+                GLuint materialBuffer;
+                GLint material;
+                glm::mat4 ModelMatrix;
+            };
+            static void setBucketState(const void *data);
+
+            std::vector<Bucket> buckets;
+            BBox3f bbox;
+            GLuint vbo;
+            GLuint ibo;
+            GLuint vao;
+            GLuint indirectBuffer;
+            GLuint materialBuffer;
+    };
+
+#endif // MODELRENDERER
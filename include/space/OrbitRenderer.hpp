@@ -0,0 +1,80 @@
+#ifndef ORBITRENDERER
+#define ORBITRENDERER
+    #include <vector>
+    #include <GL/glew.h>
+    #include <glimac/common.hpp>
+    #include <glimac/RenderQueue.hpp>
+    #include <space/Texture.hpp>
+
+    using namespace glimac;
+    using namespace glm;
+
+    /*
+     * Donnees propres a chaque orbite, lues par instance dans orbit.vs.glsl.
+     */
+    struct OrbitInstance {
+        glm::vec4 orbit; // demi grand axe, excentricite, inclinaison, longitude du noeud ascendant
+        glm::vec4 color;
+    };
+
+    class OrbitRenderer {
+        public :
+            /*
+             * Constructeur du renderer d'orbites.
+             * @param segments : le nombre de sommets de chaque boucle.
+             */
+            OrbitRenderer(GLsizei segments = 256);
+
+            /*
+             * Destructeur
+             */
+            ~OrbitRenderer();
+
+            /*
+             * Ajoute une orbite elliptique dont le foyer est au centre du repere.
+             * @param semiMajorAxis : le demi grand axe.
+             * @param eccentricity : l'excentricite (0 pour un cercle).
+             * @param inclination : l'inclinaison sur le plan xz, en radians.
+             * @param ascendingNode : la longitude du noeud ascendant (rotation autour de y), en radians.
+             * @param color : la couleur du trace.
+             */
+            void addOrbit(GLfloat semiMajorAxis, GLfloat eccentricity, GLfloat inclination, GLfloat ascendingNode, const glm::vec4 &color);
+
+            /*
+             * Supprime toutes les orbites.
+             */
+            void clear();
+
+            /*
+             * Ajoute a la file un seul dessin instancie pour toutes les orbites (envoyees au GPU si elles ont change).
+             * @param queue : la file de rendu de la frame.
+             * @param program : le programme des orbites.
+             * @param ModelMatrix : le repere commun des orbites.
+             */
+            void submit(RenderQueue &queue, const OrbitProgram &program, const glm::mat4 &ModelMatrix);
+
+            /*
+             * Renvoie le nombre d'orbites.
+             */
+            GLsizei getOrbitCount() const;
+
+        private :
+            OrbitRenderer(const OrbitRenderer&);
+            OrbitRenderer& operator =(const OrbitRenderer&);
+
+            // Etat du dessin, applique par la file de rendu juste avant le dessin
+            struct OrbitDrawData {
+                const OrbitProgram *program;
+                glm::mat4 ModelMatrix;
+                GLint segments;
+            };
+            static void setOrbitState(const void *data);
+
+            std::vector<OrbitInstance> orbits;
+            GLsizei segments;
+            bool dirty; // orbites modifiees depuis le dernier envoi
+            GLuint vboInstances;
+            GLuint vao;
+    };
+
+#endif // ORBITRENDERER
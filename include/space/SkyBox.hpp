@@ -7,6 +7,8 @@
     #include <space/Texture.hpp>
     #include <glimac/Program.hpp>
     #include <glimac/FilePath.hpp>
+    #include <glimac/RenderQueue.hpp>
+    #include <glimac/GeometryArena.hpp>
 
     using namespace glimac;
     using namespace glm;
@@ -15,10 +17,13 @@
     	public :
             /*
              * Constructeur de la skybox.
+             * @param geometry : l'arena ou ranger le cube (envoyee au GPU plus tard, avant le premier dessin).
              * @param count_vertex_skybox : le nombre de vertex.
              * @param verticesSkybox : les vertices de la skybox.
+             * @param count_index_skybox : le nombre d'indices.
+             * @param indicesSkybox : les indices des triangles de la skybox.
              */
-            SkyBox(const GLsizei count_vertex_skybox, const ShapeVertex *verticesSkybox);
+            SkyBox(GeometryArena &geometry, const GLsizei count_vertex_skybox, const ShapeVertex *verticesSkybox, const GLsizei count_index_skybox, const GLuint *indicesSkybox);
 
             /*
              * Destructeur
@@ -26,31 +31,45 @@
             ~SkyBox();
 
             /*
-             * Creation de la skybox.
+             * Creation de la skybox : ajoute le cube a l'arena.
+             * @param geometry : l'arena des maillages statiques.
              * @param count_vertex_skybox : le nombre de vertex.
              * @param verticesSkybox : les vertices de la skybox.
+             * @param count_index_skybox : le nombre d'indices.
+             * @param indicesSkybox : les indices des triangles de la skybox.
              */
-            void buildSkyBox(const GLsizei count_vertex_skybox, const ShapeVertex *verticesSkybox);
+            void buildSkyBox(GeometryArena &geometry, const GLsizei count_vertex_skybox, const ShapeVertex *verticesSkybox, const GLsizei count_index_skybox, const GLuint *indicesSkybox);
 
             /*
-             * Chargement de la cubemap.
-             * @param faces : un vecteur contenant les faces de la skybox.
+             * Creation d'une cubemap aux faces noires, en attendant ses images (chargement asynchrone).
              */
-            unsigned int loadCubemap(std::vector<std::string> faces);
+            unsigned int createCubemap();
 
             /*
-             * Permet l'activation et l'affichage de la skybox.
+             * Envoi des six faces de la cubemap, si elles ont toutes ete chargees et ont la meme taille.
+             * @param textureID : l'identifiant de la cubemap.
+             * @param faces : les images des faces, dans l'ordre +X, -X, +Y, -Y, +Z, -Z.
+             */
+            void uploadCubemap(unsigned int textureID, const std::vector<std::unique_ptr<Image>> &faces);
+
+            /*
+             * Ajoute le dessin de la skybox a la file de rendu (passe de fond, sans test de profondeur).
+             * @param queue : la file de rendu de la frame.
              * @param skytext : le programme de la skybox qui permet le chargement des textures.
              * @param cubemapTexture : l'identifiant de la texture souhaitée.
-             * @param distRendu : la distance de rendu.
-             * @param ratio_h_w : le ratio en fonction de la taille de la fenetre.
-             * @param VMatrix : la view matrice.
              */
-            void activeSkyBox(const Skytext &skytext, const GLuint &cubemapTexture, float distRendu, float ratio_h_w, glm::mat4 VMatrix);
+            void activeSkyBox(RenderQueue &queue, const Skytext &skytext, const GLuint &cubemapTexture);
 
         private :
-        	GLuint vbo;
-        	GLuint vao;
+            // Decodage des positions, applique par la file de rendu juste avant le dessin
+            struct SkyBoxDrawData {
+                const Skytext *program;
+                VertexQuantization quantization;
+            };
+            static void setSkyBoxState(const void *data);
+
+            const GeometryArena *geometry;
+            MeshHandle mesh;
     };
 
 #endif // SKYBOX
\ No newline at end of file
@@ -5,71 +5,185 @@
     #include <glimac/Image.hpp>
     #include <glimac/common.hpp>
     #include <glimac/Program.hpp>
+    #include <glimac/ProgramManager.hpp>
     #include <glimac/FilePath.hpp>
+    #include <glimac/CameraUniforms.hpp>
 
     using namespace glimac;
     using namespace glm;
 
-    struct MultiTexProgram {
-        Program m_Program;
-        GLint uMVPMatrix;
-        GLint uMVMatrix;
-        GLint uNormalMatrix;
-        GLint uEarthTexture;
-        GLint uCloudTexture;
-        MultiTexProgram(const FilePath& applicationPath):
-            m_Program(loadProgram(applicationPath.dirPath() + "../shaders/3D.vs.glsl",
-                                  applicationPath.dirPath() + "../shaders/multiTex3D.fs.glsl")) {
-            uMVPMatrix = glGetUniformLocation(m_Program.getGLId(), "uMVPMatrix");
-            uMVMatrix = glGetUniformLocation(m_Program.getGLId(), "uMVMatrix");
-            uNormalMatrix = glGetUniformLocation(m_Program.getGLId(), "uNormalMatrix");
-            uEarthTexture = glGetUniformLocation(m_Program.getGLId(), "uTexture");
-            uCloudTexture = glGetUniformLocation(m_Program.getGLId(), "uTexture2");
+    // Define ajoute aux shaders quand les sommets sont au format compact (PackedShapeVertex)
+    const std::string PACKED_VERTICES_DEFINE = "#define PACKED_VERTICES\n";
+
+    // Fonction inseree dans les shaders des textures sRGB, qui les lisent decodees en lineaire (filtrage et mipmaps
+    // corrects) : la couleur est recodee en sRGB pour l'ecran, SDL 1.2 ne donnant pas de framebuffer sRGB.
+    // Precisions explicites : elle precede les precisions par defaut des shaders.
+    const std::string LINEAR_TO_SRGB_FUNCTION =
+        "mediump vec3 linearToSrgb(mediump vec3 color) {\n"
+        "    return mix(color * 12.92, 1.055 * pow(color, vec3(1.0 / 2.4)) - 0.055, step(vec3(0.0031308), color));\n"
+        "}\n";
+
+    // Unite de texture reservee a la texture array des astres, liee par la file de rendu pour chaque dessin qui l'utilise
+    const GLint TEXTURE_ARRAY_UNIT = 1;
+
+    // Filtrage anisotrope maximal des textures mipmappees (borne aussi par le pilote)
+    const GLfloat MAX_TEXTURE_ANISOTROPY = 8.f;
+
+    struct InstancedTexProgram {
+        const Program& m_Program;
+        GLint uTextureArray;
+        GLint uPositionScale;
+        GLint uPositionBias;
+        InstancedTexProgram(const FilePath& applicationPath, bool packedVertices = false):
+            m_Program(ProgramManager::loadProgram(applicationPath.dirPath() + "../shaders/instanced3D.vs.glsl",
+                                  applicationPath.dirPath() + "../shaders/texArray3D.fs.glsl",
+                                  (packedVertices ? PACKED_VERTICES_DEFINE : "") + LINEAR_TO_SRGB_FUNCTION)) {
+            bindCameraBlock(m_Program.getGLId());
+            uTextureArray = glGetUniformLocation(m_Program.getGLId(), "uTextureArray");
+            uPositionScale = glGetUniformLocation(m_Program.getGLId(), "uPositionScale");
+            uPositionBias = glGetUniformLocation(m_Program.getGLId(), "uPositionBias");
+            m_Program.use();
+            glUniform1i(uTextureArray, TEXTURE_ARRAY_UNIT);
+        }
+    };
+
+    struct LayerTexProgram {
+        const Program& m_Program;
+        GLint uModelMatrix;
+        GLint uTextureArray;
+        GLint uLayer;
+        GLint uPositionScale;
+        GLint uPositionBias;
+        LayerTexProgram(const FilePath& applicationPath, bool packedVertices = false):
+            m_Program(ProgramManager::loadProgram(applicationPath.dirPath() + "../shaders/3D.vs.glsl",
+                                  applicationPath.dirPath() + "../shaders/texLayer3D.fs.glsl",
+                                  (packedVertices ? PACKED_VERTICES_DEFINE : "") + LINEAR_TO_SRGB_FUNCTION)) {
+            uModelMatrix = glGetUniformLocation(m_Program.getGLId(), "uModelMatrix");
+            bindCameraBlock(m_Program.getGLId());
+            uTextureArray = glGetUniformLocation(m_Program.getGLId(), "uTextureArray");
+            uLayer = glGetUniformLocation(m_Program.getGLId(), "uLayer");
+            uPositionScale = glGetUniformLocation(m_Program.getGLId(), "uPositionScale");
+            uPositionBias = glGetUniformLocation(m_Program.getGLId(), "uPositionBias");
+            m_Program.use();
+            glUniform1i(uTextureArray, TEXTURE_ARRAY_UNIT);
         }
     };
 
-    struct TexProgram {
-        Program m_Program;
-        GLint uMVPMatrix;
-        GLint uMVMatrix;
-        GLint uNormalMatrix;
-        GLint uTexture;
-        TexProgram(const FilePath& applicationPath):
-            m_Program(loadProgram(applicationPath.dirPath() + "../shaders/3D.vs.glsl",
-                                  applicationPath.dirPath() + "../shaders/tex3D.fs.glsl")) {
-            uMVPMatrix = glGetUniformLocation(m_Program.getGLId(), "uMVPMatrix");
-            uMVMatrix = glGetUniformLocation(m_Program.getGLId(), "uMVMatrix");
-            uNormalMatrix = glGetUniformLocation(m_Program.getGLId(), "uNormalMatrix");
-            uTexture = glGetUniformLocation(m_Program.getGLId(), "uTexture");
+    struct OrbitProgram {
+        const Program& m_Program;
+        GLint uModelMatrix;
+        GLint uSegments;
+        OrbitProgram(const FilePath& applicationPath):
+            m_Program(ProgramManager::loadProgram(applicationPath.dirPath() + "../shaders/orbit.vs.glsl",
+                                  applicationPath.dirPath() + "../shaders/orbit.fs.glsl")) {
+            uModelMatrix = glGetUniformLocation(m_Program.getGLId(), "uModelMatrix");
+            uSegments = glGetUniformLocation(m_Program.getGLId(), "uSegments");
+            bindCameraBlock(m_Program.getGLId());
+        }
+    };
+
+    struct UpscaleProgram {
+        const Program& m_Program;
+        GLint uScene;
+        GLint uUvScale;
+        GLint uTexelSize;
+        GLint uSharpness;
+        UpscaleProgram(const FilePath& applicationPath):
+            m_Program(ProgramManager::loadProgram(applicationPath.dirPath() + "../shaders/upscale.vs.glsl",
+                                  applicationPath.dirPath() + "../shaders/upscale.fs.glsl")) {
+            uScene = glGetUniformLocation(m_Program.getGLId(), "uScene");
+            uUvScale = glGetUniformLocation(m_Program.getGLId(), "uUvScale");
+            uTexelSize = glGetUniformLocation(m_Program.getGLId(), "uTexelSize");
+            uSharpness = glGetUniformLocation(m_Program.getGLId(), "uSharpness");
+        }
+    };
+
+    struct ModelProgram {
+        const Program& m_Program;
+        GLint uModelMatrix;
+        GLint uMaterialIndex;
+        ModelProgram(const FilePath& applicationPath):
+            m_Program(ProgramManager::loadProgram(applicationPath.dirPath() + "../shaders/model.vs.glsl",
+                                  applicationPath.dirPath() + "../shaders/model.fs.glsl")) {
+            uModelMatrix = glGetUniformLocation(m_Program.getGLId(), "uModelMatrix");
+            uMaterialIndex = glGetUniformLocation(m_Program.getGLId(), "uMaterialIndex");
+            bindCameraBlock(m_Program.getGLId());
         }
     };
 
     struct Skytext {
-        glimac::Program m_Program;
+        const glimac::Program& m_Program;
         GLint uCubemap;
-        GLint uMVP;
-        Skytext(const glimac::FilePath& applicationPath): m_Program(loadProgram(applicationPath.dirPath() + "../shaders/skybox.vs.glsl",
-                                                                                applicationPath.dirPath() + "../shaders/skybox.fs.glsl")) {
+        GLint uPositionScale;
+        GLint uPositionBias;
+        Skytext(const glimac::FilePath& applicationPath, bool packedVertices = false):
+            m_Program(ProgramManager::loadProgram(applicationPath.dirPath() + "../shaders/skybox.vs.glsl",
+                                  applicationPath.dirPath() + "../shaders/skybox.fs.glsl",
+                                  (packedVertices ? PACKED_VERTICES_DEFINE : "") + LINEAR_TO_SRGB_FUNCTION)) {
             uCubemap = glGetUniformLocation(m_Program.getGLId(), "uCubemap");
-            uMVP = glGetUniformLocation(m_Program.getGLId(), "uMVP");
+            uPositionScale = glGetUniformLocation(m_Program.getGLId(), "uPositionScale");
+            uPositionBias = glGetUniformLocation(m_Program.getGLId(), "uPositionBias");
+            bindCameraBlock(m_Program.getGLId());
         }
     };
         
     class Texture {
     	public :
             /*
-             * Permet le bind de la texture.
+             * Permet le bind de la texture : envoi de l'image dans son format et de ses mipmaps (precalculees
+             * ou, a defaut, generees par le GPU), filtrage trilineaire et anisotrope.
              * @param texLoad : chargement d'une texture.
              * @param texture : l'identifiant de la texture chargée.
              */
     		void firstBindTexture(std::unique_ptr<Image> &texLoad, GLuint texture);
 
+            /*
+             * Renvoie les formats GL d'une image : format interne de la texture, format et type des pixels envoyes.
+             * Les formats sRGB sont stockes en GL_SRGB8(_ALPHA8) : le GPU les decode en lineaire a la lecture.
+             * @param format : le format de l'image.
+             */
+            static void getGLFormat(PixelFormat format, GLenum &internalFormat, GLenum &pixelFormat, GLenum &type);
+
+            /*
+             * Filtrage trilineaire, et anisotrope si le pilote le permet, de la texture liee a target.
+             * @param target : la cible de la texture (GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP...).
+             */
+            static void setMipmapFiltering(GLenum target);
+
+            /*
+             * Renvoie le nombre de niveaux de la chaine complete de mipmaps (jusqu'a 1x1) d'une texture.
+             * @param width : la largeur du niveau 0.
+             * @param height : la hauteur du niveau 0.
+             */
+            static GLint getMipmapLevelCount(GLsizei width, GLsizei height);
+
             /*
              * Activation et desactivation de texture.
              * @param tex : l'enum de la texture.
              * @param texture : l'identifiant de la texture.
              */
     		void activeAndBindTexture(GLenum tex, GLuint texture);
+
+            /*
+             * Cree une texture array mipmappee dont chaque couche est remplie d'une couleur unie, en attendant son image.
+             * @param layers : le nombre de couches.
+             * @param width : la largeur commune des couches.
+             * @param height : la hauteur commune des couches.
+             * @param format : le format des couches (celui de leurs images).
+             * @param placeholder : la couleur des couches, dans le codage du format (sRGB pour les formats sRGB).
+             */
+            GLuint createTextureArray(GLsizei layers, GLsizei width, GLsizei height, PixelFormat format, const glm::vec4 &placeholder);
+
+            /*
+             * Remplace une couche d'une texture array creee par createTextureArray (reechantillonnee si besoin) avec
+             * les mipmaps de l'image, calculees sur le CPU si l'image n'en a pas : les autres couches sont intactes.
+             * @param texture : l'identifiant de la texture array.
+             * @param layer : l'indice de la couche.
+             * @param width : la largeur commune des couches, donnee a createTextureArray.
+             * @param height : la hauteur commune des couches, donnee a createTextureArray.
+             * @param image : la nouvelle image de la couche (ses mipmaps y sont ajoutees si besoin).
+             */
+            void uploadTextureLayer(GLuint texture, GLsizei layer, GLsizei width, GLsizei height, Image &image);
     };
 
 #endif // TEXTURE
\ No newline at end of file
@@ -5,21 +5,41 @@ layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
-uniform mat4 uMVPMatrix;
-uniform mat4 uMVMatrix;
-uniform mat4 uNormalMatrix;
+#ifdef PACKED_VERTICES
+// Positions quantifiees sur [0, 1] : position = aPosition * uPositionScale + uPositionBias
+uniform vec3 uPositionScale;
+uniform vec3 uPositionBias;
+#endif
+
+// Donnees de la frame, communes a tous les programmes (voir glimac/CameraUniforms.hpp)
+layout(std140) uniform Camera {
+    mat4 uViewMatrix;
+    mat4 uProjMatrix;
+    mat4 uViewProjMatrix;
+    float uTime;
+};
+
+// Seule donnee propre a l'objet
+uniform mat4 uModelMatrix;
 
 out vec3 vPosition;
 out vec3 vNormal;
 out vec2 vTexCoords;
 
 void main(){
+#ifdef PACKED_VERTICES
+    vec4 vertexPosition = vec4(aPosition * uPositionScale + uPositionBias, 1);
+    vec4 vertexNormal = vec4(normalize(aNormal), 0);
+#else
     vec4 vertexPosition = vec4(aPosition, 1);
     vec4 vertexNormal = vec4(aNormal, 0);
+#endif
 
+    // Les transformations des astres sont des similitudes : MV convient aussi aux normales
+    mat4 MVMatrix = uViewMatrix*uModelMatrix;
     vTexCoords = aTexCoords;
-    vPosition = vec3(uMVMatrix*vertexPosition);
-    vNormal = vec3(uNormalMatrix*vertexNormal);
+    vPosition = vec3(MVMatrix*vertexPosition);
+    vNormal = normalize(vec3(MVMatrix*vertexNormal));
 
-    gl_Position = uMVPMatrix*vertexPosition;
+    gl_Position = uViewProjMatrix*uModelMatrix*vertexPosition;
 }
@@ -0,0 +1,48 @@
+#version 300 es
+precision mediump float;
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+#ifdef PACKED_VERTICES
+// Positions quantifiees sur [0, 1] : position = aPosition * uPositionScale + uPositionBias
+uniform vec3 uPositionScale;
+uniform vec3 uPositionBias;
+#endif
+
+// Attributs par instance
+layout (location = 3) in mat4 aModelMatrix;
+layout (location = 7) in float aLayer;
+
+// Donnees de la frame, communes a tous les programmes (voir glimac/CameraUniforms.hpp)
+layout(std140) uniform Camera {
+    mat4 uViewMatrix;
+    mat4 uProjMatrix;
+    mat4 uViewProjMatrix;
+    float uTime;
+};
+
+out vec3 vPosition;
+out vec3 vNormal;
+out vec2 vTexCoords;
+flat out float vLayer;
+
+void main(){
+#ifdef PACKED_VERTICES
+    vec4 vertexPosition = vec4(aPosition * uPositionScale + uPositionBias, 1);
+    vec4 vertexNormal = vec4(normalize(aNormal), 0);
+#else
+    vec4 vertexPosition = vec4(aPosition, 1);
+    vec4 vertexNormal = vec4(aNormal, 0);
+#endif
+
+    // Les transformations des astres sont des similitudes : MV convient aussi aux normales
+    mat4 MVMatrix = uViewMatrix*aModelMatrix;
+    vTexCoords = aTexCoords;
+    vLayer = aLayer;
+    vPosition = vec3(MVMatrix*vertexPosition);
+    vNormal = normalize(vec3(MVMatrix*vertexNormal));
+
+    gl_Position = uViewProjMatrix*aModelMatrix*vertexPosition;
+}
@@ -0,0 +1,37 @@
+#version 430
+
+in vec3 vPosition;
+in vec3 vNormal;
+in vec2 vTexCoords;
+
+out vec3 fFragColor;
+
+layout(std140) uniform Camera {
+    mat4 uViewMatrix;
+    mat4 uProjMatrix;
+    mat4 uViewProjMatrix;
+    float uTime;
+};
+
+// Materiaux du modele (voir space/ModelRenderer.hpp), un seul par appel de dessin
+struct Material {
+    vec4 diffuse;  // Kd, opacite
+    vec4 specular; // Ks, brillance
+    vec4 emission; // Le
+};
+layout(std430, binding = 1) readonly buffer Materials {
+    Material uMaterials[];
+};
+uniform int uMaterialIndex;
+
+void main() {
+    Material material = uMaterials[uMaterialIndex];
+    // Eclairage de Blinn-Phong par le soleil, place a l'origine du monde
+    vec3 N = normalize(vNormal);
+    vec3 L = normalize(uViewMatrix[3].xyz - vPosition);
+    vec3 H = normalize(L - normalize(vPosition));
+    float shininess = max(material.specular.w, 1.0);
+    fFragColor = material.emission.rgb
+        + material.diffuse.rgb * (0.1 + max(dot(N, L), 0.0))
+        + material.specular.rgb * pow(max(dot(N, H), 0.0), shininess);
+}
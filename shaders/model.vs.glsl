@@ -0,0 +1,29 @@
+#version 430
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+// Donnees de la frame, communes a tous les programmes (voir glimac/CameraUniforms.hpp)
+layout(std140) uniform Camera {
+    mat4 uViewMatrix;
+    mat4 uProjMatrix;
+    mat4 uViewProjMatrix;
+    float uTime;
+};
+
+uniform mat4 uModelMatrix;
+
+out vec3 vPosition;
+out vec3 vNormal;
+out vec2 vTexCoords;
+
+void main(){
+    // Les modeles ne subissent que des similitudes : MV convient aussi aux normales
+    mat4 MVMatrix = uViewMatrix*uModelMatrix;
+    vTexCoords = aTexCoords;
+    vPosition = vec3(MVMatrix*vec4(aPosition, 1));
+    vNormal = normalize(vec3(MVMatrix*vec4(aNormal, 0)));
+
+    gl_Position = uViewProjMatrix*uModelMatrix*vec4(aPosition, 1);
+}
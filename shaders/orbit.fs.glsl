@@ -0,0 +1,10 @@
+#version 300 es
+precision mediump float;
+
+in vec4 vColor;
+
+out vec3 fFragColor;
+
+void main() {
+    fFragColor = vColor.rgb;
+}
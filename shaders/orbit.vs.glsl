@@ -0,0 +1,37 @@
+#version 300 es
+precision highp float;
+
+// Attributs par instance : une orbite
+layout (location = 0) in vec4 aOrbit; // demi grand axe, excentricite, inclinaison, longitude du noeud ascendant
+layout (location = 1) in vec4 aColor;
+
+// Donnees de la frame, communes a tous les programmes (voir glimac/CameraUniforms.hpp)
+layout(std140) uniform Camera {
+    mat4 uViewMatrix;
+    mat4 uProjMatrix;
+    mat4 uViewProjMatrix;
+    float uTime;
+};
+
+uniform mat4 uModelMatrix;
+uniform int uSegments; // nombre de sommets de la boucle
+
+out vec4 vColor;
+
+void main() {
+    // Aucun sommet en memoire : l'angle vient du numero du sommet
+    float theta = 6.28318530718 * float(gl_VertexID) / float(uSegments);
+    float a = aOrbit.x;
+    float e = aOrbit.y;
+    // Ellipse dont le foyer est au centre du repere, dans le plan xz
+    float r = a * (1.0 - e * e) / (1.0 + e * cos(theta));
+    vec3 position = vec3(r * cos(theta), 0.0, r * sin(theta));
+    // Inclinaison autour de x, puis noeud ascendant autour de y
+    float ci = cos(aOrbit.z), si = sin(aOrbit.z);
+    position = vec3(position.x, -position.z * si, position.z * ci);
+    float cn = cos(aOrbit.w), sn = sin(aOrbit.w);
+    position = vec3(position.x * cn + position.z * sn, position.y, position.z * cn - position.x * sn);
+
+    vColor = aColor;
+    gl_Position = uViewProjMatrix * uModelMatrix * vec4(position, 1.0);
+}
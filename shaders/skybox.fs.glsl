@@ -8,5 +8,6 @@ uniform samplerCube uCubemap;
 out vec4 fFragColor;
 
 void main() {
-    fFragColor = texture(uCubemap, vTexture);
+    vec4 color = texture(uCubemap, vTexture);
+    fFragColor = vec4(linearToSrgb(color.rgb), color.a);
 }
@@ -3,11 +3,29 @@ precision mediump float;
 
 layout (location = 0) in vec3 aPosition;
 
-uniform mat4 uMVP;
+#ifdef PACKED_VERTICES
+// Positions quantifiees sur [0, 1] : position = aPosition * uPositionScale + uPositionBias
+uniform vec3 uPositionScale;
+uniform vec3 uPositionBias;
+#endif
+
+// Donnees de la frame, communes a tous les programmes (voir glimac/CameraUniforms.hpp)
+layout(std140) uniform Camera {
+    mat4 uViewMatrix;
+    mat4 uProjMatrix;
+    mat4 uViewProjMatrix;
+    float uTime;
+};
 
 out vec3 vTexture;
 
 void main() {
-    vTexture = aPosition;
-    gl_Position = uMVP * vec4(aPosition, 1.0);
+#ifdef PACKED_VERTICES
+    vec3 position = aPosition * uPositionScale + uPositionBias;
+#else
+    vec3 position = aPosition;
+#endif
+    vTexture = position;
+    // Seule la rotation de la vue s'applique : la skybox suit la camera
+    gl_Position = uProjMatrix * mat4(mat3(uViewMatrix)) * vec4(position, 1.0);
 }
@@ -0,0 +1,17 @@
+#version 300 es
+precision mediump float;
+precision mediump sampler2DArray;
+
+in vec3 vPosition;
+in vec3 vNormal;
+in vec2 vTexCoords;
+flat in float vLayer;
+
+out vec3 fFragColor;
+
+uniform sampler2DArray uTextureArray;
+
+// linearToSrgb() est inseree par le programme (LINEAR_TO_SRGB_FUNCTION de Texture.hpp)
+void main() {
+	fFragColor = linearToSrgb(texture(uTextureArray, vec3(vTexCoords, vLayer)).xyz);
+}
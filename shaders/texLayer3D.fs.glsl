@@ -0,0 +1,16 @@
+#version 300 es
+precision mediump float;
+precision mediump sampler2DArray;
+
+in vec3 vPosition;
+in vec3 vNormal;
+in vec2 vTexCoords;
+
+out vec3 fFragColor;
+
+uniform sampler2DArray uTextureArray;
+uniform float uLayer;
+
+void main() {
+	fFragColor = linearToSrgb(texture(uTextureArray, vec3(vTexCoords, uLayer)).xyz);
+}
@@ -0,0 +1,30 @@
+#version 300 es
+precision mediump float;
+
+in vec2 vTexCoords; // [0, 1] sur l'ecran
+
+uniform sampler2D uScene;
+uniform vec2 uUvScale;   // taille de la zone rendue / taille de la texture
+uniform vec2 uTexelSize; // 1 / taille de la texture
+uniform float uSharpness;
+
+out vec4 fFragColor;
+
+void main() {
+    // Echantillons limites a la zone rendue : le reste de la texture date d'une autre echelle
+    vec2 uvMin = 0.5 * uTexelSize;
+    vec2 uvMax = uUvScale - 0.5 * uTexelSize;
+    vec2 uv = clamp(vTexCoords * uUvScale, uvMin, uvMax);
+    vec3 center = texture(uScene, uv).rgb;
+    vec3 north = texture(uScene, clamp(uv + vec2(0.0, uTexelSize.y), uvMin, uvMax)).rgb;
+    vec3 south = texture(uScene, clamp(uv - vec2(0.0, uTexelSize.y), uvMin, uvMax)).rgb;
+    vec3 east = texture(uScene, clamp(uv + vec2(uTexelSize.x, 0.0), uvMin, uvMax)).rgb;
+    vec3 west = texture(uScene, clamp(uv - vec2(uTexelSize.x, 0.0), uvMin, uvMax)).rgb;
+
+    // Masque flou : le laplacien renforce les contours adoucis par le filtrage bilineaire,
+    // le resultat est borne par le voisinage pour ne pas creer de halos
+    vec3 sharpened = center + uSharpness * (4.0 * center - north - south - east - west);
+    vec3 lowest = min(center, min(min(north, south), min(east, west)));
+    vec3 highest = max(center, max(max(north, south), max(east, west)));
+    fFragColor = vec4(clamp(sharpened, lowest, highest), 1.0);
+}
@@ -0,0 +1,11 @@
+#version 300 es
+precision highp float;
+
+// Triangle couvrant l'ecran, calcule a partir de gl_VertexID (aucun attribut)
+out vec2 vTexCoords;
+
+void main() {
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    vTexCoords = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
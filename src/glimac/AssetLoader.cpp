@@ -0,0 +1,56 @@
+#include <algorithm>
+#include "glimac/AssetLoader.hpp"
+
+namespace glimac {
+
+AssetLoader::AssetLoader(): m_Requested(0), m_Delivered(0) {
+}
+
+AssetLoader::~AssetLoader() {
+    wait();
+}
+
+unsigned int AssetLoader::loadImage(const FilePath& filepath, PixelFormat format,
+                                    unsigned int width, unsigned int height, bool mipmaps) {
+    unsigned int id = m_Requested++;
+    JobHandle job = JobSystem::create([this, id, filepath, format, width, height, mipmaps] {
+        std::unique_ptr<Image> image = glimac::loadImage(filepath, format);
+        if(image && width > 0 && height > 0 && (image->getWidth() != width || image->getHeight() != height)) {
+            image = resizeImage(*image, width, height);
+        }
+        if(image && mipmaps) {
+            image->generateMipmaps();
+        }
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Decoded.push_back(DecodedImage{ id, std::move(image) });
+    });
+    m_Jobs.push_back(job);
+    JobSystem::run(job);
+    return id;
+}
+
+unsigned int AssetLoader::update(const ImageCallback& callback) {
+    std::vector<DecodedImage> decoded;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        decoded.swap(m_Decoded);
+    }
+    // The callback (texture upload) runs outside of the lock, the jobs never wait for the GL thread
+    for(DecodedImage& entry : decoded) {
+        callback(entry.id, std::move(entry.image));
+    }
+    m_Delivered += decoded.size();
+    if(!decoded.empty()) {
+        m_Jobs.erase(std::remove_if(m_Jobs.begin(), m_Jobs.end(), JobSystem::isDone), m_Jobs.end());
+    }
+    return decoded.size();
+}
+
+void AssetLoader::wait() {
+    for(const JobHandle& job : m_Jobs) {
+        JobSystem::wait(job);
+    }
+    m_Jobs.clear();
+}
+
+}
@@ -0,0 +1,55 @@
+#include <cstring>
+#include "glimac/CameraUniforms.hpp"
+#include "glimac/GLState.hpp"
+
+namespace glimac {
+
+CameraUniformBuffer::CameraUniformBuffer() {
+    m_Uniforms.ViewMatrix = m_Uniforms.ProjMatrix = m_Uniforms.ViewProjMatrix = glm::mat4(1.f);
+    m_Uniforms.time = 0.f;
+
+    glGenBuffers(1, &m_Buffer);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, m_Buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraUniforms), &m_Uniforms, GL_STREAM_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, m_Buffer);
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_OffsetAlignment);
+}
+
+CameraUniformBuffer::~CameraUniformBuffer() {
+    GLState::deleteBuffers(1, &m_Buffer);
+}
+
+void CameraUniformBuffer::update(const glm::mat4& ViewMatrix, const glm::mat4& ProjMatrix, GLfloat time) {
+    m_Uniforms.ViewMatrix = ViewMatrix;
+    m_Uniforms.ProjMatrix = ProjMatrix;
+    m_Uniforms.ViewProjMatrix = ProjMatrix * ViewMatrix;
+    m_Uniforms.time = time;
+
+    // The whole block is replaced: orphaning avoids waiting for the previous frame
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, m_Buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraUniforms), &m_Uniforms, GL_STREAM_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, m_Buffer);
+}
+
+void CameraUniformBuffer::update(StreamBuffer& stream, const glm::mat4& ViewMatrix, const glm::mat4& ProjMatrix, GLfloat time) {
+    StreamBuffer::Allocation allocation = stream.allocate(sizeof(CameraUniforms), m_OffsetAlignment);
+    if(!allocation.data) {
+        update(ViewMatrix, ProjMatrix, time);
+        return;
+    }
+    m_Uniforms.ViewMatrix = ViewMatrix;
+    m_Uniforms.ProjMatrix = ProjMatrix;
+    m_Uniforms.ViewProjMatrix = ProjMatrix * ViewMatrix;
+    m_Uniforms.time = time;
+    std::memcpy(allocation.data, &m_Uniforms, sizeof(CameraUniforms));
+    glBindBufferRange(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, stream.getBuffer(), allocation.offset, sizeof(CameraUniforms));
+}
+
+void bindCameraBlock(GLuint program) {
+    GLuint index = glGetUniformBlockIndex(program, "Camera");
+    if(index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, index, CAMERA_UNIFORM_BINDING);
+    }
+}
+
+}
@@ -3,6 +3,7 @@
 #include <iostream>
 #include "glimac/common.hpp"
 #include "glimac/Cone.hpp"
+#include "glimac/MeshOptimizer.hpp"
 
 namespace glimac {
 
@@ -54,26 +55,27 @@ void Cone::build(GLfloat height, GLfloat r, GLsizei discLat, GLsizei discHeight)
         }
     }
 
-    m_nVertexCount = discLat * discHeight * 6;
-    
-    // Construit les vertex finaux en regroupant les données en triangles:
+    // Construit les triangles en indexant les sommets de la grille:
     // Pour une longitude donnée, les deux triangles formant une face sont de la forme:
     // (i, i + 1, i + discLat + 1), (i, i + discLat + 1, i + discLat)
     // avec i sur la bande correspondant à la longitude
+    std::vector<GLuint> indices;
     for(GLsizei j = 0; j < discHeight; ++j) {
-        GLsizei offset = j * discLat;
+        GLuint offset = j * discLat;
         for(GLsizei i = 0; i < discLat; ++i) {
-            m_Vertices.push_back(data[offset + i]);
-            m_Vertices.push_back(data[offset + (i + 1) % discLat]);
-            m_Vertices.push_back(data[offset + discLat + (i + 1) % discLat]);
-            m_Vertices.push_back(data[offset + i]);
-            m_Vertices.push_back(data[offset + discLat + (i + 1) % discLat]);
-            m_Vertices.push_back(data[offset + i + discLat]);
+            indices.push_back(offset + i);
+            indices.push_back(offset + (i + 1) % discLat);
+            indices.push_back(offset + discLat + (i + 1) % discLat);
+            indices.push_back(offset + i);
+            indices.push_back(offset + discLat + (i + 1) % discLat);
+            indices.push_back(offset + i + discLat);
         }
     }
-    
-    // Attention ! dans cette implantation on duplique beaucoup de sommets. Une meilleur stratégie est de passer
-    // par un Index Buffer Object, que nous verrons dans les prochains TDs
+
+    m_Vertices = data;
+    m_Indices = indices;
+    optimizeMesh(m_Vertices, m_Indices);
+    m_nVertexCount = m_Vertices.size();
 }
 
 }
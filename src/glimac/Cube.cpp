@@ -3,6 +3,7 @@
 #include <iostream>
 #include "glimac/common.hpp"
 #include "glimac/Cube.hpp"
+#include "glimac/MeshOptimizer.hpp"
 
 namespace glimac {
 
@@ -226,7 +227,9 @@ namespace glimac {
         vertex.position = glm::vec3(size_c,0,0);
         data.push_back(vertex);
 
-        m_nVertexCount = 36;
-        m_Vertices = data;
+        // Fusion des sommets identiques : 24 sommets distincts pour 36 indices
+        indexTriangles(data, m_Vertices, m_Indices);
+        optimizeMesh(m_Vertices, m_Indices);
+        m_nVertexCount = m_Vertices.size();
     }
 }
@@ -0,0 +1,367 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include "glimac/FrameCapture.hpp"
+#include "glimac/GLState.hpp"
+
+namespace glimac {
+
+// PNG encoding: filter 0 and stored (uncompressed) deflate blocks. Files are larger than with zlib, but
+// a worker encodes a 1080p frame in a few milliseconds and no library is needed.
+
+static std::uint32_t crc32(std::uint32_t crc, const unsigned char* data, size_t size) {
+    struct Table {
+        std::uint32_t values[256];
+
+        Table() {
+            for(std::uint32_t n = 0; n < 256; ++n) {
+                std::uint32_t c = n;
+                for(int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                values[n] = c;
+            }
+        }
+    };
+    // Built once, by the first worker to get here
+    static const Table table;
+    crc = ~crc;
+    for(size_t i = 0; i < size; ++i) {
+        crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static std::uint32_t adler32(const unsigned char* data, size_t size) {
+    std::uint32_t a = 1, b = 0;
+    while(size > 0) {
+        // Largest run before b can overflow
+        size_t run = std::min<size_t>(size, 5552);
+        for(size_t i = 0; i < run; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += run;
+        size -= run;
+    }
+    return (b << 16) | a;
+}
+
+static void putUint32(std::vector<unsigned char>& out, std::uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+static void putChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, size_t size) {
+    putUint32(out, size);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    putUint32(out, crc32(0, out.data() + start, size + 4));
+}
+
+// scanlines: height rows of 1 filter byte followed by width RGB pixels
+static void encodePNG(const std::vector<unsigned char>& scanlines, GLsizei width, GLsizei height, std::vector<unsigned char>& out) {
+    static const unsigned char SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.assign(SIGNATURE, SIGNATURE + 8);
+
+    unsigned char header[13];
+    for(int i = 0; i < 4; ++i) {
+        header[i] = (width >> (24 - 8 * i)) & 0xFF;
+        header[4 + i] = (height >> (24 - 8 * i)) & 0xFF;
+    }
+    header[8] = 8;  // bits per channel
+    header[9] = 2;  // RGB
+    header[10] = 0; // deflate
+    header[11] = 0; // adaptive filtering
+    header[12] = 0; // no interlacing
+    putChunk(out, "IHDR", header, sizeof(header));
+
+    const size_t BLOCK_SIZE = 65535;
+    size_t size = scanlines.size();
+    size_t blockCount = std::max<size_t>(1, (size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    std::vector<unsigned char> zlib;
+    zlib.reserve(2 + size + 5 * blockCount + 4);
+    zlib.push_back(0x78); // deflate, 32K window
+    zlib.push_back(0x01); // no preset dictionary, header checksum
+    for(size_t offset = 0, block = 0; block < blockCount; ++block, offset += BLOCK_SIZE) {
+        size_t length = std::min(BLOCK_SIZE, size - offset);
+        zlib.push_back(block + 1 == blockCount ? 1 : 0); // final block flag, stored
+        zlib.push_back(length & 0xFF);
+        zlib.push_back(length >> 8);
+        zlib.push_back(~length & 0xFF);
+        zlib.push_back((~length >> 8) & 0xFF);
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+    }
+    putUint32(zlib, adler32(scanlines.data(), size));
+    putChunk(out, "IDAT", zlib.data(), zlib.size());
+    putChunk(out, "IEND", nullptr, 0);
+}
+
+FrameCapture::FrameCapture(GLsizei width, GLsizei height, const FilePath& outputPath, unsigned int framesPerSecond,
+                           unsigned int frameCount, GLuint bufferCount):
+    m_Width(width), m_Height(height), m_Format(PNG), m_Valid(false), m_Stream(nullptr),
+    m_Slots(std::max(bufferCount, 1u)), m_Frame(0), m_Captured(0), m_Dropped(0), m_NextWrite(0), m_Writing(false) {
+    std::string ext = outputPath.ext();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    m_Path = outputPath.str().substr(0, outputPath.str().size() - (ext.empty() ? 0 : ext.size() + 1));
+    if(ext == "y4m") {
+        m_Format = Y4M;
+    } else if(ext == "rgb" || ext == "raw") {
+        m_Format = RAW;
+    } else if(ext != "png") {
+        // Anything else is the prefix of a PNG sequence
+        m_Path = outputPath.str();
+    }
+
+    if(m_Format != PNG) {
+        m_Stream = std::fopen(outputPath.c_str(), "wb");
+        if(!m_Stream) {
+            std::cerr << "FrameCapture: cannot open " << outputPath.str() << std::endl;
+            return;
+        }
+        if(m_Format == Y4M) {
+            std::fprintf(m_Stream, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C420jpeg\n", width, height, framesPerSecond);
+        }
+    }
+    m_Valid = true;
+
+    GLsizeiptr frameSize = GLsizeiptr(width) * height * 4;
+    for(Slot& slot : m_Slots) {
+        glGenBuffers(1, &slot.buffer);
+        GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameSize, nullptr, GL_STREAM_READ);
+    }
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // The encoding buffers of a frame grow on its first use and are kept
+    for(unsigned int i = 0; i < std::max(frameCount, 1u); ++i) {
+        m_Frames.emplace_back(new Frame());
+        m_Frames.back()->pixels.resize(frameSize);
+        m_FreeFrames.push_back(m_Frames.back().get());
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    finish();
+    for(Slot& slot : m_Slots) {
+        GLState::deleteBuffers(1, &slot.buffer);
+    }
+}
+
+void FrameCapture::capture(GLuint framebuffer) {
+    if(!m_Valid) {
+        return;
+    }
+    GLuint count = m_Slots.size();
+    readBackCompleted();
+    Slot& slot = m_Slots[m_Frame % count];
+    if(slot.fence) {
+        // The ring wrapped onto a copy the GPU has not done yet: drop this frame rather than wait for it
+        ++m_Dropped;
+        return;
+    }
+
+    // Asynchronous: the pixels are copied into the buffer when the GPU reaches this point
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++m_Frame;
+
+    // Normally frees the oldest frame of the ring, issued count - 1 frames ago
+    readBackCompleted();
+}
+
+void FrameCapture::readBackCompleted() {
+    // Oldest first, up to the first copy still running, so that frames keep their order
+    GLuint count = m_Slots.size();
+    for(GLuint i = 0; i < count; ++i) {
+        Slot& slot = m_Slots[(m_Frame + i) % count];
+        if(slot.fence && !readBack(slot, false)) {
+            return;
+        }
+    }
+}
+
+bool FrameCapture::readBack(Slot& slot, bool wait) {
+    if(!slot.fence) {
+        return true;
+    }
+    // Polled with a zero timeout, the slot is deferred to a later frame if the copy is not done
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    GLuint64 timeout = wait ? 1000000 : 0;
+    while(glClientWaitSync(slot.fence, flags, timeout) == GL_TIMEOUT_EXPIRED) {
+        if(!wait) {
+            return false;
+        }
+        flags = 0;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    Frame* frame = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if(!m_FreeFrames.empty()) {
+            frame = m_FreeFrames.back();
+            m_FreeFrames.pop_back();
+        }
+    }
+    if(!frame) {
+        // The jobs are behind: drop the frame rather than wait for them
+        ++m_Dropped;
+        return true;
+    }
+
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame->pixels.size(), GL_MAP_READ_BIT);
+    if(data) {
+        std::memcpy(frame->pixels.data(), data, frame->pixels.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if(!data) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_FreeFrames.push_back(frame);
+        ++m_Dropped;
+        return true;
+    }
+
+    frame->index = m_Captured++;
+    JobHandle job = JobSystem::create([this, frame] {
+        encode(*frame);
+        write(*frame);
+    });
+    m_Jobs.push_back(job);
+    JobSystem::run(job);
+    // Forget the jobs already done, m_Jobs stays as small as the pool
+    m_Jobs.erase(std::remove_if(m_Jobs.begin(), m_Jobs.end(), JobSystem::isDone), m_Jobs.end());
+    return true;
+}
+
+void FrameCapture::finish() {
+    if(!m_Valid) {
+        return;
+    }
+    // Remaining frames of the ring, oldest first, waiting for the GPU this time
+    GLuint count = m_Slots.size();
+    for(GLuint i = 0; i < count; ++i) {
+        readBack(m_Slots[(m_Frame + i) % count], true);
+    }
+    for(const JobHandle& job : m_Jobs) {
+        JobSystem::wait(job);
+    }
+    m_Jobs.clear();
+    if(m_Stream) {
+        std::fclose(m_Stream);
+        m_Stream = nullptr;
+    }
+    m_Valid = false;
+}
+
+void FrameCapture::encode(Frame& frame) const {
+    const unsigned char* pixels = frame.pixels.data();
+    std::vector<unsigned char>& scratch = frame.scratch;
+    std::vector<unsigned char>& output = frame.output;
+    size_t width = m_Width, height = m_Height;
+    // GL rows start at the bottom of the image
+    auto row = [&](size_t y) { return pixels + (height - 1 - y) * width * 4; };
+
+    if(m_Format == Y4M) {
+        // BT.601 studio range, chroma averaged over 2x2 blocks
+        size_t chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+        static const char FRAME_HEADER[] = "FRAME\n";
+        output.resize(6 + width * height + 2 * chromaWidth * chromaHeight);
+        std::memcpy(output.data(), FRAME_HEADER, 6);
+        unsigned char* Y = output.data() + 6;
+        unsigned char* U = Y + width * height;
+        unsigned char* V = U + chromaWidth * chromaHeight;
+        for(size_t y = 0; y < height; ++y) {
+            const unsigned char* src = row(y);
+            for(size_t x = 0; x < width; ++x, src += 4) {
+                Y[y * width + x] = (66 * src[0] + 129 * src[1] + 25 * src[2] + 128 + (16 << 8)) >> 8;
+            }
+        }
+        for(size_t cy = 0; cy < chromaHeight; ++cy) {
+            const unsigned char* rows[2] = { row(2 * cy), row(std::min(2 * cy + 1, height - 1)) };
+            for(size_t cx = 0; cx < chromaWidth; ++cx) {
+                size_t x0 = 2 * cx * 4, x1 = std::min(2 * cx + 1, width - 1) * 4;
+                int r = 0, g = 0, b = 0;
+                for(const unsigned char* src : rows) {
+                    r += src[x0] + src[x1];
+                    g += src[x0 + 1] + src[x1 + 1];
+                    b += src[x0 + 2] + src[x1 + 2];
+                }
+                U[cy * chromaWidth + cx] = ((-38 * r - 74 * g + 112 * b) / 4 + 128 + (128 << 8)) >> 8;
+                V[cy * chromaWidth + cx] = ((112 * r - 94 * g - 18 * b) / 4 + 128 + (128 << 8)) >> 8;
+            }
+        }
+        return;
+    }
+
+    // PNG scanlines carry a leading filter byte, raw frames do not
+    size_t prefix = (m_Format == PNG) ? 1 : 0;
+    std::vector<unsigned char>& rgb = (m_Format == PNG) ? scratch : output;
+    rgb.resize(height * (prefix + width * 3));
+    unsigned char* dst = rgb.data();
+    for(size_t y = 0; y < height; ++y) {
+        if(prefix) {
+            *dst++ = 0;
+        }
+        const unsigned char* src = row(y);
+        for(size_t x = 0; x < width; ++x, src += 4, dst += 3) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+    if(m_Format == PNG) {
+        encodePNG(scratch, m_Width, m_Height, output);
+    }
+}
+
+void FrameCapture::write(Frame& frame) {
+    if(m_Format == PNG) {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "_%06u.png", frame.index);
+        std::string path = m_Path + suffix;
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if(file) {
+            std::fwrite(frame.output.data(), 1, frame.output.size(), file);
+            std::fclose(file);
+        } else {
+            std::cerr << "FrameCapture: cannot open " << path << std::endl;
+        }
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_FreeFrames.push_back(&frame);
+        return;
+    }
+
+    // Streams are appended in frame order: a frame that is not next waits in m_Encoded, and the job that
+    // completes the next one writes every frame ready from there. The writes are done outside of the lock
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Encoded[frame.index] = &frame;
+    if(m_Writing) {
+        return;
+    }
+    m_Writing = true;
+    for(auto next = m_Encoded.find(m_NextWrite); next != m_Encoded.end(); next = m_Encoded.find(m_NextWrite)) {
+        Frame* ready = next->second;
+        m_Encoded.erase(next);
+        lock.unlock();
+        std::fwrite(ready->output.data(), 1, ready->output.size(), m_Stream);
+        lock.lock();
+        m_FreeFrames.push_back(ready);
+        ++m_NextWrite;
+    }
+    m_Writing = false;
+}
+
+}
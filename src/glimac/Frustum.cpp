@@ -0,0 +1,86 @@
+#include "glimac/Frustum.hpp"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace glimac {
+
+Frustum extractFrustum(const glm::mat4& clipMatrix) {
+    // Rows of the matrix, glm stores columns
+    glm::mat4 m = glm::transpose(clipMatrix);
+    Frustum frustum;
+    frustum.planes[0] = m[3] + m[0];
+    frustum.planes[1] = m[3] - m[0];
+    frustum.planes[2] = m[3] + m[1];
+    frustum.planes[3] = m[3] - m[1];
+    frustum.planes[4] = m[3] + m[2];
+    frustum.planes[5] = m[3] - m[2];
+    for(auto& plane: frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+bool intersects(const Frustum& frustum, const glm::vec3& center, float radius) {
+    for(const auto& plane: frustum.planes) {
+        if(glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, std::vector<GLuint>& visible) {
+    const size_t count = spheres.size();
+    const size_t first = visible.size();
+    const float* x = spheres.x.data();
+    const float* y = spheres.y.data();
+    const float* z = spheres.z.data();
+    const float* r = spheres.radius.data();
+    size_t i = 0;
+
+#if defined(__AVX__)
+    for(; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(r + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for(const auto& plane: frustum.planes) {
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(plane.x)), _mm256_set1_ps(plane.w));
+            d = _mm256_add_ps(d, _mm256_mul_ps(py, _mm256_set1_ps(plane.y)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(pz, _mm256_set1_ps(plane.z)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negRadius, _CMP_GE_OQ));
+        }
+        for(int mask = _mm256_movemask_ps(inside); mask; mask &= mask - 1) {
+            visible.push_back(i + __builtin_ctz(mask));
+        }
+    }
+#endif
+
+#if defined(__SSE2__)
+    for(; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(const auto& plane: frustum.planes) {
+            __m128 d = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+            d = _mm_add_ps(d, _mm_mul_ps(py, _mm_set1_ps(plane.y)));
+            d = _mm_add_ps(d, _mm_mul_ps(pz, _mm_set1_ps(plane.z)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negRadius));
+        }
+        for(int mask = _mm_movemask_ps(inside); mask; mask &= mask - 1) {
+            visible.push_back(i + __builtin_ctz(mask));
+        }
+    }
+#endif
+
+    // Remaining spheres (or every sphere without SSE)
+    for(; i < count; ++i) {
+        if(intersects(frustum, glm::vec3(x[i], y[i], z[i]), r[i])) {
+            visible.push_back(i);
+        }
+    }
+    return visible.size() - first;
+}
+
+}
@@ -0,0 +1,166 @@
+#include "glimac/GLState.hpp"
+
+#include <algorithm>
+
+namespace glimac {
+
+namespace {
+
+const GLuint UNKNOWN = ~0u;
+
+int textureTargetIndex(GLenum target) {
+    switch(target) {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        case GL_TEXTURE_CUBE_MAP: return 2;
+        case GL_TEXTURE_3D: return 3;
+        default: return -1;
+    }
+}
+
+int capabilityIndex(GLenum capability) {
+    switch(capability) {
+        case GL_DEPTH_TEST: return 0;
+        case GL_BLEND: return 1;
+        case GL_CULL_FACE: return 2;
+        case GL_SCISSOR_TEST: return 3;
+        default: return -1;
+    }
+}
+
+}
+
+GLuint GLState::m_Program = UNKNOWN;
+GLuint GLState::m_VertexArray = UNKNOWN;
+GLuint GLState::m_ArrayBuffer = UNKNOWN;
+GLuint GLState::m_ActiveUnit = UNKNOWN;
+// Set to UNKNOWN by the invalidate() that follows the creation of the context
+GLuint GLState::m_Textures[GLState::MAX_TEXTURE_UNITS][4];
+GLuint GLState::m_Capabilities[4] = { UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN };
+GLState::Counters GLState::m_Frame = { 0, 0 };
+GLState::Counters GLState::m_LastFrame = { 0, 0 };
+
+bool GLState::update(GLuint& shadow, GLuint value) {
+    if(shadow == value) {
+        ++m_Frame.elided;
+        return false;
+    }
+    shadow = value;
+    ++m_Frame.issued;
+    return true;
+}
+
+void GLState::useProgram(GLuint program) {
+    if(update(m_Program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void GLState::bindVertexArray(GLuint vao) {
+    if(update(m_VertexArray, vao)) {
+        glBindVertexArray(vao);
+    }
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer) {
+    if(target != GL_ARRAY_BUFFER) {
+        ++m_Frame.issued;
+        glBindBuffer(target, buffer);
+    } else if(update(m_ArrayBuffer, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void GLState::activeTexture(GLuint unit) {
+    if(update(m_ActiveUnit, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void GLState::bindTexture(GLenum target, GLuint texture) {
+    int index = textureTargetIndex(target);
+    if(index < 0 || m_ActiveUnit >= MAX_TEXTURE_UNITS) {
+        ++m_Frame.issued;
+        glBindTexture(target, texture);
+    } else if(update(m_Textures[m_ActiveUnit][index], texture)) {
+        glBindTexture(target, texture);
+    }
+}
+
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    int index = textureTargetIndex(target);
+    if(index >= 0 && unit < MAX_TEXTURE_UNITS && m_Textures[unit][index] == texture) {
+        // Already bound: not even the unit needs to change
+        ++m_Frame.elided;
+        return;
+    }
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+void GLState::enable(GLenum capability) {
+    setEnabled(capability, true);
+}
+
+void GLState::disable(GLenum capability) {
+    setEnabled(capability, false);
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled) {
+    int index = capabilityIndex(capability);
+    if(index < 0) {
+        ++m_Frame.issued;
+    } else if(!update(m_Capabilities[index], enabled)) {
+        return;
+    }
+    enabled ? glEnable(capability) : glDisable(capability);
+}
+
+void GLState::deleteProgram(GLuint program) {
+    if(m_Program == program) {
+        m_Program = UNKNOWN;
+    }
+    glDeleteProgram(program);
+}
+
+void GLState::deleteVertexArrays(GLsizei count, const GLuint* vaos) {
+    for(GLsizei i = 0; i < count; ++i) {
+        if(m_VertexArray == vaos[i]) {
+            m_VertexArray = UNKNOWN;
+        }
+    }
+    glDeleteVertexArrays(count, vaos);
+}
+
+void GLState::deleteBuffers(GLsizei count, const GLuint* buffers) {
+    for(GLsizei i = 0; i < count; ++i) {
+        if(m_ArrayBuffer == buffers[i]) {
+            m_ArrayBuffer = UNKNOWN;
+        }
+    }
+    glDeleteBuffers(count, buffers);
+}
+
+void GLState::deleteTextures(GLsizei count, const GLuint* textures) {
+    for(GLsizei i = 0; i < count; ++i) {
+        for(auto& unit: m_Textures) {
+            std::replace(unit, unit + 4, textures[i], UNKNOWN);
+        }
+    }
+    glDeleteTextures(count, textures);
+}
+
+void GLState::invalidate() {
+    m_Program = m_VertexArray = m_ArrayBuffer = m_ActiveUnit = UNKNOWN;
+    for(auto& unit: m_Textures) {
+        std::fill(unit, unit + 4, UNKNOWN);
+    }
+    std::fill(m_Capabilities, m_Capabilities + 4, UNKNOWN);
+}
+
+void GLState::newFrame() {
+    m_LastFrame = m_Frame;
+    m_Frame.issued = m_Frame.elided = 0;
+}
+
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include "glimac/GeometryArena.hpp"
+#include "glimac/GLState.hpp"
+
+namespace glimac {
+
+GeometryArena::GeometryArena(bool packedVertices, GLuint position, GLuint normal, GLuint texCoords):
+    m_Packed(packedVertices), m_AttribPosition(position), m_AttribNormal(normal), m_AttribTexCoords(texCoords),
+    m_VertexCount(0), m_VBO(0), m_IBO(0), m_VAO(0) {
+}
+
+GeometryArena::~GeometryArena() {
+    GLState::deleteBuffers(1, &m_VBO);
+    GLState::deleteBuffers(1, &m_IBO);
+    GLState::deleteVertexArrays(1, &m_VAO);
+}
+
+MeshHandle GeometryArena::add(const ShapeVertex* vertices, GLsizei vertexCount, const GLuint* indices, GLsizei indexCount) {
+    MeshHandle mesh;
+    if(m_VAO) {
+        // The CPU copies are gone and the buffers are immutable: the mesh would never be drawable
+        std::cerr << "GeometryArena: mesh added after upload(), ignored" << std::endl;
+        return mesh;
+    }
+    mesh.baseVertex = m_VertexCount;
+    mesh.vertexCount = vertexCount;
+    mesh.firstIndex = m_Indices.size();
+    mesh.indexCount = indexCount;
+    if(m_Packed) {
+        std::vector<PackedShapeVertex> packed = packShapeVertices(vertices, vertexCount, mesh.quantization);
+        m_PackedVertices.insert(m_PackedVertices.end(), packed.begin(), packed.end());
+    } else {
+        m_Vertices.insert(m_Vertices.end(), vertices, vertices + vertexCount);
+    }
+    m_Indices.insert(m_Indices.end(), indices, indices + indexCount);
+    m_VertexCount += vertexCount;
+    m_Meshes.push_back(mesh);
+    return mesh;
+}
+
+void GeometryArena::upload() {
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_IBO);
+    glGenVertexArrays(1, &m_VAO);
+
+    GLState::bindVertexArray(m_VAO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    if(m_Packed) {
+        glBufferData(GL_ARRAY_BUFFER, m_PackedVertices.size() * sizeof(PackedShapeVertex), m_PackedVertices.data(), GL_STATIC_DRAW);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, m_Vertices.size() * sizeof(ShapeVertex), m_Vertices.data(), GL_STATIC_DRAW);
+    }
+    setShapeVertexAttribPointers(m_Packed, m_AttribPosition, m_AttribNormal, m_AttribTexCoords);
+    // The index buffer is part of the VAO state
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Indices.size() * sizeof(GLuint), m_Indices.data(), GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
+
+    std::vector<ShapeVertex>().swap(m_Vertices);
+    std::vector<PackedShapeVertex>().swap(m_PackedVertices);
+    std::vector<GLuint>().swap(m_Indices);
+}
+
+}
@@ -2,17 +2,161 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 namespace glimac {
 
-std::unique_ptr<Image> loadImage(const FilePath& filepath) {
+unsigned int getChannelCount(PixelFormat format) {
+    return (format == PixelFormat::RGB8 || format == PixelFormat::SRGB8) ? 3 : 4;
+}
+
+unsigned int getBytesPerPixel(PixelFormat format) {
+    return format == PixelFormat::RGBA32F ? sizeof(glm::vec4) : getChannelCount(format);
+}
+
+bool isSRGB(PixelFormat format) {
+    return format == PixelFormat::SRGB8 || format == PixelFormat::SRGB8_ALPHA8;
+}
+
+namespace {
+
+float srgbToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float value) {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+}
+
+// Linear value of each 8 bit sRGB value
+struct SrgbTable {
+    float values[256];
+
+    SrgbTable() {
+        for(int i = 0; i < 256; ++i) {
+            values[i] = srgbToLinear(i / 255.f);
+        }
+    }
+};
+
+const float* getSrgbTable() {
+    static const SrgbTable table;
+    return table.values;
+}
+
+// Pixels of an 8 bit image as linear RGBA floats (alpha 1 without alpha channel)
+std::vector<glm::vec4> decodePixels(const Image& image) {
+    std::vector<glm::vec4> pixels(size_t(image.getWidth()) * image.getHeight(), glm::vec4(1.f));
+    unsigned int channels = getChannelCount(image.getFormat());
+    bool srgb = isSRGB(image.getFormat());
+    const float* table = getSrgbTable();
+    const unsigned char* data = image.getData();
+    for(auto& pixel : pixels) {
+        for(unsigned int c = 0; c < channels; ++c) {
+            pixel[c] = (srgb && c < 3) ? table[data[c]] : data[c] / 255.f;
+        }
+        data += channels;
+    }
+    return pixels;
+}
+
+void encodePixels(const glm::vec4* pixels, Image& image) {
+    unsigned int channels = getChannelCount(image.getFormat());
+    bool srgb = isSRGB(image.getFormat());
+    unsigned char* data = image.getData();
+    size_t count = size_t(image.getWidth()) * image.getHeight();
+    for(size_t i = 0; i < count; ++i) {
+        for(unsigned int c = 0; c < channels; ++c) {
+            float value = glm::clamp(pixels[i][c], 0.f, 1.f);
+            if(srgb && c < 3) {
+                value = linearToSrgb(value);
+            }
+            data[c] = (unsigned char)(value * 255.f + 0.5f);
+        }
+        data += channels;
+    }
+}
+
+void resamplePixels(const glm::vec4* src, unsigned int srcWidth, unsigned int srcHeight,
+                    glm::vec4* ptr, unsigned int width, unsigned int height) {
+    float scaleX = float(srcWidth) / width;
+    float scaleY = float(srcHeight) / height;
+    for(auto y = 0u; y < height; ++y) {
+        for(auto x = 0u; x < width; ++x) {
+            if(scaleX > 1.f || scaleY > 1.f) {
+                // Shrinking: average every source texel covered by the destination texel
+                auto x0 = (unsigned int)(x * scaleX), x1 = std::max(x0 + 1, (unsigned int)((x + 1) * scaleX));
+                auto y0 = (unsigned int)(y * scaleY), y1 = std::max(y0 + 1, (unsigned int)((y + 1) * scaleY));
+                x1 = std::min(x1, srcWidth);
+                y1 = std::min(y1, srcHeight);
+                glm::vec4 sum(0.f);
+                for(auto sy = y0; sy < y1; ++sy) {
+                    for(auto sx = x0; sx < x1; ++sx) {
+                        sum += src[sy * srcWidth + sx];
+                    }
+                }
+                *ptr = sum / float((x1 - x0) * (y1 - y0));
+            } else {
+                // Enlarging: bilinear interpolation between the four nearest texels
+                float fx = glm::clamp((x + 0.5f) * scaleX - 0.5f, 0.f, float(srcWidth - 1));
+                float fy = glm::clamp((y + 0.5f) * scaleY - 0.5f, 0.f, float(srcHeight - 1));
+                auto x0 = (unsigned int)fx, y0 = (unsigned int)fy;
+                auto x1 = std::min(x0 + 1, srcWidth - 1), y1 = std::min(y0 + 1, srcHeight - 1);
+                auto top = glm::mix(src[y0 * srcWidth + x0], src[y0 * srcWidth + x1], fx - x0);
+                auto bottom = glm::mix(src[y1 * srcWidth + x0], src[y1 * srcWidth + x1], fx - x0);
+                *ptr = glm::mix(top, bottom, fy - y0);
+            }
+            ++ptr;
+        }
+    }
+}
+
+}
+
+void Image::fill(const glm::vec4& color) {
+    size_t count = size_t(m_nWidth) * m_nHeight;
+    if(m_Format == PixelFormat::RGBA32F) {
+        std::fill(getPixels(), getPixels() + count, color);
+        return;
+    }
+    unsigned int channels = getChannelCount(m_Format);
+    unsigned char bytes[4];
+    for(unsigned int c = 0; c < 4; ++c) {
+        bytes[c] = (unsigned char)(glm::clamp(color[c], 0.f, 1.f) * 255.f + 0.5f);
+    }
+    unsigned char* data = m_Data.get();
+    for(size_t i = 0; i < count; ++i) {
+        std::copy(bytes, bytes + channels, data);
+        data += channels;
+    }
+}
+
+void Image::generateMipmaps() {
+    m_Mipmaps.clear();
+    const Image* level = this;
+    while(level->getWidth() > 1 || level->getHeight() > 1) {
+        m_Mipmaps.push_back(resizeImage(*level, std::max(1u, level->getWidth() / 2), std::max(1u, level->getHeight() / 2)));
+        level = m_Mipmaps.back().get();
+    }
+}
+
+// Called from the jobs of AssetLoader: stbi_load only shares the failure reason between threads
+std::unique_ptr<Image> loadImage(const FilePath& filepath, PixelFormat format) {
     int x, y, n;
-    unsigned char *data = stbi_load(filepath.c_str(), &x, &y, &n, 4);
+    int channels = getChannelCount(format);
+    unsigned char *data = stbi_load(filepath.c_str(), &x, &y, &n, channels);
     if(!data) {
         std::cerr << "loading image " << filepath << " error: " << stbi_failure_reason() << std::endl;
         return std::unique_ptr<Image>();
     }
-    std::unique_ptr<Image> pImage(new Image(x, y));
+    std::unique_ptr<Image> pImage(new Image(x, y, format));
+    if(format != PixelFormat::RGBA32F) {
+        // Decoded bytes kept as they are
+        std::copy(data, data + pImage->getDataSize(), pImage->getData());
+        stbi_image_free(data);
+        return pImage;
+    }
     unsigned int size = x * y;
     auto scale = 1.f / 255;
     auto ptr = pImage->getPixels();
@@ -28,6 +172,20 @@ std::unique_ptr<Image> loadImage(const FilePath& filepath) {
     return pImage;
 }
 
+std::unique_ptr<Image> resizeImage(const Image& image, unsigned int width, unsigned int height) {
+    std::unique_ptr<Image> pImage(new Image(width, height, image.getFormat()));
+    if(image.getFormat() == PixelFormat::RGBA32F) {
+        resamplePixels(image.getPixels(), image.getWidth(), image.getHeight(), pImage->getPixels(), width, height);
+        return pImage;
+    }
+    // 8 bit formats: filtered as linear floats, then encoded back
+    std::vector<glm::vec4> src = decodePixels(image);
+    std::vector<glm::vec4> dst(size_t(width) * height);
+    resamplePixels(src.data(), image.getWidth(), image.getHeight(), dst.data(), width, height);
+    encodePixels(dst.data(), *pImage);
+    return pImage;
+}
+
 std::unordered_map<FilePath, std::unique_ptr<Image>> ImageManager::m_ImageMap;
 
 const Image* ImageManager::loadImage(const FilePath& filepath) {
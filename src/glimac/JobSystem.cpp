@@ -0,0 +1,369 @@
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <algorithm>
+#include "glimac/JobSystem.hpp"
+
+namespace glimac {
+
+struct Job {
+    std::function<void()> work;
+    JobHandle parent;
+    JobHandle self;                // set while the job is queued, the deques only hold raw pointers
+    std::atomic<int> unfinished;   // the job itself and its unfinished children
+    std::atomic<int> dependencies; // unfinished dependencies, plus one until run() is called
+    std::mutex mutex;              // protects done and continuations
+    bool done;
+    std::vector<JobHandle> continuations;
+
+    Job(): unfinished(1), dependencies(1), done(false) {
+    }
+};
+
+namespace {
+
+// Chase-Lev deque (with the memory orderings of Le, Pop, Cohen, Zappa Nardelli 2013), fixed capacity:
+// push() fails when full and the job is then run immediately by its owner
+class WorkStealingDeque {
+public:
+    static const int64_t CAPACITY = 4096;
+
+    WorkStealingDeque(): m_Top(0), m_Bottom(0) {
+        for(auto& slot : m_Jobs) {
+            slot.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    // Owner only
+    bool push(Job* job) {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        if(bottom - top >= CAPACITY) {
+            return false;
+        }
+        m_Jobs[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only
+    Job* pop() {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_Top.load(std::memory_order_relaxed);
+        if(top > bottom) {
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Job* job = m_Jobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if(top == bottom) {
+            // Last job: race against the thieves
+            if(!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    // Any thread
+    Job* steal() {
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+        if(top >= bottom) {
+            return nullptr;
+        }
+        Job* job = m_Jobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if(!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+private:
+    // top and bottom on separate cache lines: thieves write one, the owner the other
+    std::atomic<int64_t> m_Top;
+    char m_TopPadding[64];
+    std::atomic<int64_t> m_Bottom;
+    char m_BottomPadding[64];
+    std::atomic<Job*> m_Jobs[CAPACITY];
+};
+
+// Failed steals in a row before a worker goes to sleep
+const int SPIN_COUNT = 64;
+
+std::vector<std::unique_ptr<WorkStealingDeque>> g_Deques; // one per thread of the pool, 0 for the initializing thread
+std::vector<std::thread> g_Workers;
+unsigned int g_ThreadCount = 1;
+std::atomic<bool> g_Stop(false);
+
+// Jobs pushed by threads outside of the pool
+std::mutex g_SharedMutex;
+std::deque<Job*> g_SharedJobs;
+
+// Sleeping workers are woken when jobs are queued
+std::mutex g_SleepMutex;
+std::condition_variable g_WakeUp;
+std::atomic<int> g_Queued(0);   // jobs in the deques and the shared queue
+std::atomic<int> g_Sleeping(0);
+
+// Index of the thread in the pool, -1 outside of it
+thread_local int t_ThreadIndex = -1;
+thread_local uint32_t t_Random = 0x9E3779B9u;
+
+uint32_t nextRandom() {
+    // xorshift32, per thread
+    t_Random ^= t_Random << 13;
+    t_Random ^= t_Random >> 17;
+    t_Random ^= t_Random << 5;
+    return t_Random;
+}
+
+void execute(Job* job);
+
+void schedule(const JobHandle& job) {
+    if(g_ThreadCount == 1) {
+        // Single thread mode: run right away, in program order
+        job->self = job;
+        execute(job.get());
+        return;
+    }
+    job->self = job;
+    g_Queued.fetch_add(1);
+    bool queued = true;
+    if(t_ThreadIndex >= 0) {
+        queued = g_Deques[t_ThreadIndex]->push(job.get());
+    } else {
+        std::lock_guard<std::mutex> lock(g_SharedMutex);
+        g_SharedJobs.push_back(job.get());
+    }
+    if(!queued) {
+        // Deque full: run it now
+        g_Queued.fetch_sub(1);
+        execute(job.get());
+        return;
+    }
+    if(g_Sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(g_SleepMutex);
+        g_WakeUp.notify_one();
+    }
+}
+
+void finish(Job* job) {
+    if(job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    std::vector<JobHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->done = true;
+        continuations.swap(job->continuations);
+    }
+    for(const JobHandle& continuation : continuations) {
+        if(continuation->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            schedule(continuation);
+        }
+    }
+    if(job->parent) {
+        JobHandle parent = std::move(job->parent);
+        finish(parent.get());
+    }
+}
+
+void execute(Job* job) {
+    // The queue reference is dropped here, the handles keep the job alive if needed
+    JobHandle keep = std::move(job->self);
+    if(job->work) {
+        job->work();
+    }
+    finish(job);
+}
+
+Job* findJob() {
+    Job* job = nullptr;
+    if(t_ThreadIndex >= 0) {
+        job = g_Deques[t_ThreadIndex]->pop();
+    }
+    if(!job) {
+        std::lock_guard<std::mutex> lock(g_SharedMutex);
+        if(!g_SharedJobs.empty()) {
+            job = g_SharedJobs.front();
+            g_SharedJobs.pop_front();
+        }
+    }
+    if(!job) {
+        // Random victim, then the following ones
+        unsigned int start = nextRandom() % g_ThreadCount;
+        for(unsigned int i = 0; i < g_ThreadCount && !job; ++i) {
+            unsigned int victim = (start + i) % g_ThreadCount;
+            if(int(victim) != t_ThreadIndex) {
+                job = g_Deques[victim]->steal();
+            }
+        }
+    }
+    if(job) {
+        g_Queued.fetch_sub(1);
+    }
+    return job;
+}
+
+void workerLoop(int index) {
+    t_ThreadIndex = index;
+    t_Random ^= uint32_t(index) * 0x85EBCA6Bu;
+    int idle = 0;
+    for(;;) {
+        Job* job = findJob();
+        if(job) {
+            execute(job);
+            idle = 0;
+            continue;
+        }
+        if(++idle < SPIN_COUNT) {
+            std::this_thread::yield();
+            continue;
+        }
+        // Nothing to do: sleep until a job is queued. Queued is checked after announcing the sleep,
+        // and schedule() checks Sleeping after queuing, so a wake-up cannot be missed.
+        std::unique_lock<std::mutex> lock(g_SleepMutex);
+        g_Sleeping.fetch_add(1);
+        g_WakeUp.wait(lock, [] { return g_Queued.load() > 0 || g_Stop.load(); });
+        g_Sleeping.fetch_sub(1);
+        idle = 0;
+        if(g_Stop.load() && g_Queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+// Joins the workers if the program leaves without calling shutdown() (destroyed before the globals above)
+struct ShutdownAtExit {
+    ~ShutdownAtExit() {
+        JobSystem::shutdown();
+    }
+} g_ShutdownAtExit;
+
+}
+
+void JobSystem::initialize(unsigned int threadCount) {
+    shutdown();
+    if(threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    g_ThreadCount = threadCount;
+    g_Stop.store(false);
+    g_Deques.clear();
+    for(unsigned int i = 0; i < threadCount; ++i) {
+        g_Deques.emplace_back(new WorkStealingDeque());
+    }
+    t_ThreadIndex = 0;
+    for(unsigned int i = 1; i < threadCount; ++i) {
+        g_Workers.emplace_back(workerLoop, int(i));
+    }
+}
+
+void JobSystem::shutdown() {
+    if(g_Workers.empty()) {
+        g_ThreadCount = 1;
+        return;
+    }
+    // Run what is left, then let the workers leave
+    if(t_ThreadIndex >= 0) {
+        while(Job* job = findJob()) {
+            execute(job);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_SleepMutex);
+        g_Stop.store(true);
+    }
+    g_WakeUp.notify_all();
+    for(std::thread& worker : g_Workers) {
+        worker.join();
+    }
+    g_Workers.clear();
+    g_ThreadCount = 1;
+    t_ThreadIndex = -1;
+}
+
+unsigned int JobSystem::getThreadCount() {
+    return g_ThreadCount;
+}
+
+JobHandle JobSystem::create(std::function<void()> work, const JobHandle& parent) {
+    JobHandle job = std::make_shared<Job>();
+    job->work = std::move(work);
+    if(parent) {
+        parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+        job->parent = parent;
+    }
+    return job;
+}
+
+void JobSystem::addDependency(const JobHandle& job, const JobHandle& dependency) {
+    job->dependencies.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(dependency->mutex);
+    if(dependency->done) {
+        // Already finished; the count cannot reach 0 here, run() has not been called yet
+        job->dependencies.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+        dependency->continuations.push_back(job);
+    }
+}
+
+void JobSystem::run(const JobHandle& job) {
+    if(job->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        schedule(job);
+    }
+}
+
+JobHandle JobSystem::then(const JobHandle& job, std::function<void()> work) {
+    JobHandle continuation = create(std::move(work));
+    addDependency(continuation, job);
+    run(continuation);
+    return continuation;
+}
+
+bool JobSystem::isDone(const JobHandle& job) {
+    return job->unfinished.load(std::memory_order_acquire) == 0;
+}
+
+void JobSystem::wait(const JobHandle& job) {
+    while(!isDone(job)) {
+        if(Job* other = findJob()) {
+            execute(other);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    if(begin >= end) {
+        return;
+    }
+    size_t count = end - begin;
+    if(grain == 0) {
+        grain = std::max<size_t>(1, count / (4 * g_ThreadCount));
+    }
+    if(g_ThreadCount == 1 || count <= grain) {
+        body(begin, end);
+        return;
+    }
+    // One child per range under an empty root: the root finishes with the last range
+    JobHandle root = create(nullptr);
+    for(size_t first = begin; first < end; first += grain) {
+        size_t last = std::min(end, first + grain);
+        run(create([&body, first, last] { body(first, last); }, root));
+    }
+    run(root);
+    wait(root);
+}
+
+}
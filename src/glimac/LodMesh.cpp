@@ -0,0 +1,103 @@
+#include "glimac/LodMesh.hpp"
+#include "glimac/Sphere.hpp"
+#include "glimac/Tore.hpp"
+#include "glimac/JobSystem.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <memory>
+
+namespace glimac {
+
+namespace {
+
+// Distance between a circle of the given radius and its inscribed polygon with `segments` sides
+float chordError(float radius, GLsizei segments) {
+    return radius * (1.f - std::cos(glm::pi<float>() / segments));
+}
+
+}
+
+void LodMesh::addLevel(const ShapeVertex* vertices, GLsizei vertexCount,
+                       const GLuint* indices, GLsizei indexCount, float geometricError) {
+    GLuint baseVertex = m_Vertices.size();
+    if(m_Vertices.empty() && vertexCount > 0) {
+        m_BBox = BBox3f(vertices[0].position);
+    }
+    for(GLsizei i = 0; i < vertexCount; ++i) {
+        m_BBox.grow(vertices[i].position);
+    }
+    m_Vertices.insert(m_Vertices.end(), vertices, vertices + vertexCount);
+
+    LodLevel level;
+    level.firstIndex = m_Indices.size();
+    level.indexCount = indexCount;
+    level.geometricError = geometricError;
+    m_Indices.reserve(m_Indices.size() + indexCount);
+    for(GLsizei i = 0; i < indexCount; ++i) {
+        m_Indices.push_back(baseVertex + indices[i]);
+    }
+    m_Levels.push_back(level);
+}
+
+GLsizei LodMesh::selectLevel(float distance, float pixelsPerUnit, float maxPixelError) const {
+    // An eye on or inside the mesh gets the finest level
+    if(distance <= 0.f) {
+        return 0;
+    }
+    float maxError = maxPixelError * distance / pixelsPerUnit;
+
+    GLsizei level = 0;
+    while(level + 1 < GLsizei(m_Levels.size()) && m_Levels[level + 1].geometricError <= maxError) {
+        ++level;
+    }
+    return level;
+}
+
+LodMesh buildSphereLod(GLfloat radius, const std::vector<glm::ivec2>& tessellations) {
+    // Levels are built in parallel, then appended in order
+    std::vector<std::unique_ptr<Sphere>> spheres(tessellations.size());
+    JobSystem::parallelFor(0, tessellations.size(), 1, [&](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i) {
+            spheres[i].reset(new Sphere(radius, tessellations[i].x, tessellations[i].y));
+        }
+    });
+    LodMesh lod;
+    for(size_t i = 0; i < tessellations.size(); ++i) {
+        const Sphere& sphere = *spheres[i];
+        const glm::ivec2& t = tessellations[i];
+        // Rayon reel du maillage (la construction passe par la sphere duale c3ga)
+        float r = glm::length(sphere.getDataPointer()[0].position);
+        float error = std::max(chordError(r, t.x), chordError(r, 2 * t.y));
+        lod.addLevel(sphere.getDataPointer(), sphere.getVertexCount(),
+                     sphere.getIndexPointer(), sphere.getIndexCount(), error);
+    }
+    return lod;
+}
+
+LodMesh buildToreLod(GLfloat ri, GLfloat re, const std::vector<glm::ivec2>& tessellations) {
+    std::vector<std::unique_ptr<Tore>> tores(tessellations.size());
+    JobSystem::parallelFor(0, tessellations.size(), 1, [&](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i) {
+            tores[i].reset(new Tore(ri, re, tessellations[i].x, tessellations[i].y));
+        }
+    });
+    LodMesh lod;
+    for(size_t i = 0; i < tessellations.size(); ++i) {
+        const Tore& tore = *tores[i];
+        const glm::ivec2& t = tessellations[i];
+        float error = std::max(chordError(re + ri, t.x), chordError(ri, t.y));
+        lod.addLevel(tore.getDataPointer(), tore.getVertexCount(),
+                     tore.getIndexPointer(), tore.getIndexCount(), error);
+    }
+    return lod;
+}
+
+float toreDistance(const glm::vec3& position, GLfloat ri, GLfloat re) {
+    // Tore::build places the ring flat in the plane z = ri + 2, between radii re - ri and re + ri
+    float radial = glm::max(0.f, std::abs(glm::length(glm::vec2(position)) - re) - ri);
+    float height = position.z - (ri + 2.f);
+    return std::sqrt(radial * radial + height * height);
+}
+
+}
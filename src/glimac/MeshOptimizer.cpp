@@ -0,0 +1,188 @@
+#include "glimac/MeshOptimizer.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+namespace glimac {
+
+namespace {
+
+const int CACHE_SIZE = 32;
+
+struct VertexHash {
+    size_t operator()(const ShapeVertex& v) const {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+        size_t hash = 14695981039346656037ull;
+        for(size_t i = 0; i < sizeof(ShapeVertex); ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const ShapeVertex& a, const ShapeVertex& b) const {
+        return std::memcmp(&a, &b, sizeof(ShapeVertex)) == 0;
+    }
+};
+
+// Score of a vertex from its position in the simulated LRU cache and its number of remaining triangles
+float vertexScore(int cachePosition, int valence) {
+    if(valence == 0) {
+        return -1.f;
+    }
+    float score = 0.f;
+    if(cachePosition >= 0) {
+        if(cachePosition < 3) {
+            // The last triangle's vertices get a fixed score so that strips are not favored over fans
+            score = 0.75f;
+        } else {
+            score = std::pow(1.f - (cachePosition - 3) * (1.f / (CACHE_SIZE - 3)), 1.5f);
+        }
+    }
+    // Boost vertices with few triangles left so that isolated triangles do not linger
+    return score + 2.f * std::pow(float(valence), -0.5f);
+}
+
+}
+
+void indexTriangles(const std::vector<ShapeVertex>& triangles,
+                    std::vector<ShapeVertex>& vertices, std::vector<GLuint>& indices) {
+    std::unordered_map<ShapeVertex, GLuint, VertexHash, VertexEqual> remap;
+    vertices.clear();
+    indices.clear();
+    indices.reserve(triangles.size());
+    for(const auto& vertex: triangles) {
+        auto it = remap.find(vertex);
+        if(it == std::end(remap)) {
+            it = remap.emplace(vertex, GLuint(vertices.size())).first;
+            vertices.push_back(vertex);
+        }
+        indices.push_back((*it).second);
+    }
+}
+
+void optimizeVertexCache(std::vector<GLuint>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if(triangleCount == 0) {
+        return;
+    }
+
+    // Vertex -> triangles adjacency, the first valence[v] entries of each range are the live triangles
+    std::vector<int> valence(vertexCount, 0);
+    for(auto index: indices) {
+        ++valence[index];
+    }
+    std::vector<size_t> offsets(vertexCount + 1, 0);
+    for(size_t v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + valence[v];
+    }
+    std::vector<GLuint> adjacency(indices.size());
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for(size_t t = 0; t < triangleCount; ++t) {
+        for(size_t k = 0; k < 3; ++k) {
+            adjacency[fill[indices[3 * t + k]]++] = t;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vScore(vertexCount);
+    for(size_t v = 0; v < vertexCount; ++v) {
+        vScore[v] = vertexScore(-1, valence[v]);
+    }
+    std::vector<float> tScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for(size_t t = 0; t < triangleCount; ++t) {
+        tScore[t] = vScore[indices[3 * t]] + vScore[indices[3 * t + 1]] + vScore[indices[3 * t + 2]];
+    }
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+    std::vector<GLuint> cache, newCache;
+    cache.reserve(CACHE_SIZE + 3);
+    newCache.reserve(CACHE_SIZE + 3);
+
+    long best = std::max_element(tScore.begin(), tScore.end()) - tScore.begin();
+    while(result.size() < indices.size()) {
+        if(best < 0) {
+            // No live triangle touches the cache: restart from the best remaining one
+            float bestScore = -1e30f;
+            for(size_t t = 0; t < triangleCount; ++t) {
+                if(!emitted[t] && tScore[t] > bestScore) {
+                    bestScore = tScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        const GLuint* tri = &indices[3 * best];
+        result.insert(result.end(), tri, tri + 3);
+        emitted[best] = true;
+
+        // Remove the triangle from the live adjacency of its vertices
+        for(size_t k = 0; k < 3; ++k) {
+            GLuint v = tri[k];
+            auto begin = adjacency.begin() + offsets[v];
+            auto end = begin + valence[v];
+            auto it = std::find(begin, end, GLuint(best));
+            std::iter_swap(it, end - 1);
+            --valence[v];
+        }
+
+        // Move the triangle's vertices to the front of the LRU cache
+        newCache.assign(tri, tri + 3);
+        for(auto v: cache) {
+            if(v != tri[0] && v != tri[1] && v != tri[2]) {
+                newCache.push_back(v);
+            }
+        }
+        for(size_t i = 0; i < newCache.size(); ++i) {
+            cachePosition[newCache[i]] = (i < size_t(CACHE_SIZE)) ? int(i) : -1;
+        }
+        for(auto v: newCache) {
+            vScore[v] = vertexScore(cachePosition[v], valence[v]);
+        }
+
+        // Only triangles touching the cache may have changed score
+        best = -1;
+        float bestScore = -1e30f;
+        for(auto v: newCache) {
+            for(size_t a = offsets[v]; a < offsets[v] + valence[v]; ++a) {
+                GLuint t = adjacency[a];
+                float score = vScore[indices[3 * t]] + vScore[indices[3 * t + 1]] + vScore[indices[3 * t + 2]];
+                tScore[t] = score;
+                if(score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+
+        if(newCache.size() > size_t(CACHE_SIZE)) {
+            newCache.resize(CACHE_SIZE);
+        }
+        std::swap(cache, newCache);
+    }
+
+    indices.swap(result);
+}
+
+void optimizeVertexFetch(std::vector<ShapeVertex>& vertices, std::vector<GLuint>& indices) {
+    const GLuint unused = GLuint(-1);
+    std::vector<GLuint> remap(vertices.size(), unused);
+    std::vector<ShapeVertex> result;
+    result.reserve(vertices.size());
+    for(auto& index: indices) {
+        if(remap[index] == unused) {
+            remap[index] = result.size();
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    // Vertices that no triangle references are dropped
+    vertices.swap(result);
+}
+
+}
@@ -0,0 +1,67 @@
+#include "glimac/PackedVertex.hpp"
+
+#include <cstddef>
+#include <cmath>
+
+namespace glimac {
+
+namespace {
+
+GLuint packSnorm10(float v) {
+    return GLuint(GLint(std::round(glm::clamp(v, -1.f, 1.f) * 511.f))) & 0x3FFu;
+}
+
+GLuint packNormal(const glm::vec3& n) {
+    return packSnorm10(n.x) | (packSnorm10(n.y) << 10) | (packSnorm10(n.z) << 20);
+}
+
+}
+
+std::vector<PackedShapeVertex> packShapeVertices(const ShapeVertex* vertices, GLsizei count,
+                                                 VertexQuantization& quantization) {
+    glm::vec3 lower(0.f), upper(0.f);
+    if(count > 0) {
+        lower = upper = vertices[0].position;
+    }
+    for(GLsizei i = 1; i < count; ++i) {
+        lower = glm::min(lower, vertices[i].position);
+        upper = glm::max(upper, vertices[i].position);
+    }
+    quantization.bias = lower;
+    quantization.scale = upper - lower;
+
+    // A flat axis (zero extent) decodes to the bias whatever the stored value
+    glm::vec3 rcpScale;
+    for(auto i = 0u; i < 3; ++i) {
+        rcpScale[i] = quantization.scale[i] > 0.f ? 65535.f / quantization.scale[i] : 0.f;
+    }
+
+    std::vector<PackedShapeVertex> packed(count);
+    for(GLsizei i = 0; i < count; ++i) {
+        glm::vec3 q = glm::clamp((vertices[i].position - lower) * rcpScale, 0.f, 65535.f);
+        packed[i].position[0] = GLushort(std::round(q.x));
+        packed[i].position[1] = GLushort(std::round(q.y));
+        packed[i].position[2] = GLushort(std::round(q.z));
+        packed[i].position[3] = 0;
+        packed[i].normal = packNormal(vertices[i].normal);
+        packed[i].texCoords = glm::packHalf2x16(vertices[i].texCoords);
+    }
+    return packed;
+}
+
+void setShapeVertexAttribPointers(bool packed, GLuint position, GLuint normal, GLuint texCoords) {
+    glEnableVertexAttribArray(position);
+    glEnableVertexAttribArray(normal);
+    glEnableVertexAttribArray(texCoords);
+    if(packed) {
+        glVertexAttribPointer(position, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedShapeVertex), (const GLvoid*)(offsetof(PackedShapeVertex, position)));
+        glVertexAttribPointer(normal, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedShapeVertex), (const GLvoid*)(offsetof(PackedShapeVertex, normal)));
+        glVertexAttribPointer(texCoords, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedShapeVertex), (const GLvoid*)(offsetof(PackedShapeVertex, texCoords)));
+    } else {
+        glVertexAttribPointer(position, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid*)(offsetof(ShapeVertex, position)));
+        glVertexAttribPointer(normal, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid*)(offsetof(ShapeVertex, normal)));
+        glVertexAttribPointer(texCoords, 2, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid*)(offsetof(ShapeVertex, texCoords)));
+    }
+}
+
+}
@@ -0,0 +1,185 @@
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include "glimac/Profiler.hpp"
+
+namespace glimac {
+
+const GLuint Profiler::FRAME_LATENCY;
+const GLuint Profiler::MAX_GPU_SCOPES;
+const size_t Profiler::EVENT_CAPACITY;
+
+bool Profiler::m_Enabled = false;
+bool Profiler::m_Initialized = false;
+uint64_t Profiler::m_Origin = 0;
+uint32_t Profiler::m_Frame = 0;
+std::vector<Profiler::Scope> Profiler::m_Stack;
+GLint Profiler::m_GpuScope = -1;
+uint64_t Profiler::m_GpuCursor = 0;
+Profiler::GpuFrame Profiler::m_GpuFrames[Profiler::FRAME_LATENCY];
+std::vector<Profiler::Event> Profiler::m_Events;
+size_t Profiler::m_EventHead = 0;
+size_t Profiler::m_EventCount = 0;
+uint64_t Profiler::m_EventTotal = 0;
+
+uint64_t Profiler::now() {
+    typedef std::chrono::high_resolution_clock Clock;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count() - m_Origin;
+}
+
+void Profiler::setEnabled(bool enabled) {
+    if(enabled && !m_Initialized) {
+        m_Origin = 0;
+        m_Origin = now();
+        for(GpuFrame& gpuFrame : m_GpuFrames) {
+            glGenQueries(MAX_GPU_SCOPES, gpuFrame.queries);
+            gpuFrame.count = 0;
+        }
+        m_Events.resize(EVENT_CAPACITY);
+        m_Stack.reserve(32);
+        m_Initialized = true;
+    }
+    m_Enabled = enabled;
+}
+
+void Profiler::shutdown() {
+    if(m_Initialized) {
+        // A query still running must be ended before it can be deleted
+        if(m_GpuScope >= 0) {
+            glEndQuery(GL_TIME_ELAPSED);
+        }
+        for(GpuFrame& gpuFrame : m_GpuFrames) {
+            glDeleteQueries(MAX_GPU_SCOPES, gpuFrame.queries);
+        }
+        m_Initialized = false;
+    }
+    m_Enabled = false;
+    m_Stack.clear();
+    m_GpuScope = -1;
+}
+
+void Profiler::startFrame() {
+    ++m_Frame;
+    // This slot was last used FRAME_LATENCY frames ago
+    GpuFrame& gpuFrame = m_GpuFrames[m_Frame % FRAME_LATENCY];
+    resolveGpuFrame(gpuFrame, false);
+    gpuFrame.count = 0;
+    gpuFrame.frame = m_Frame;
+}
+
+void Profiler::flush() {
+    if(!m_Initialized) {
+        return;
+    }
+    // Oldest frame first, the current one last
+    for(GLuint i = 1; i <= FRAME_LATENCY; ++i) {
+        GpuFrame& gpuFrame = m_GpuFrames[(m_Frame + i) % FRAME_LATENCY];
+        resolveGpuFrame(gpuFrame, true);
+        gpuFrame.count = 0;
+    }
+}
+
+void Profiler::resolveGpuFrame(GpuFrame& gpuFrame, bool wait) {
+    if(gpuFrame.count == 0) {
+        return;
+    }
+    // Queries complete in order: when the last one is available, they all are.
+    // Without wait, GL_QUERY_RESULT is only read once available and never blocks
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(gpuFrame.queries[gpuFrame.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available && !wait) {
+        return;
+    }
+    uint64_t cursor = m_GpuCursor;
+    for(GLuint i = 0; i < gpuFrame.count; ++i) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(gpuFrame.queries[i], GL_QUERY_RESULT, &elapsed);
+        Event event;
+        event.name = gpuFrame.names[i];
+        event.start = std::max(gpuFrame.cpuStarts[i], cursor);
+        event.duration = elapsed;
+        event.frame = gpuFrame.frame;
+        event.track = GPU_TRACK;
+        event.depth = 0;
+        cursor = event.start + event.duration;
+        record(event);
+    }
+    m_GpuCursor = cursor;
+}
+
+void Profiler::push(const char* name, bool gpu) {
+    Scope scope;
+    scope.name = name;
+    scope.query = -1;
+    GpuFrame& gpuFrame = m_GpuFrames[m_Frame % FRAME_LATENCY];
+    if(gpu && m_GpuScope < 0 && gpuFrame.count < MAX_GPU_SCOPES) {
+        scope.query = gpuFrame.count++;
+        m_GpuScope = m_Stack.size();
+        gpuFrame.names[scope.query] = name;
+    }
+    scope.start = now();
+    if(scope.query >= 0) {
+        gpuFrame.cpuStarts[scope.query] = scope.start;
+        glBeginQuery(GL_TIME_ELAPSED, gpuFrame.queries[scope.query]);
+    }
+    m_Stack.push_back(scope);
+}
+
+void Profiler::pop() {
+    if(m_Stack.empty()) {
+        // Scope opened while the profiler was disabled
+        return;
+    }
+    const Scope& scope = m_Stack.back();
+    if(scope.query >= 0) {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_GpuScope = -1;
+    }
+    Event event;
+    event.name = scope.name;
+    event.start = scope.start;
+    event.duration = now() - scope.start;
+    event.frame = m_Frame;
+    event.track = CPU_TRACK;
+    event.depth = m_Stack.size() - 1;
+    record(event);
+    m_Stack.pop_back();
+}
+
+void Profiler::record(const Event& event) {
+    m_Events[m_EventHead] = event;
+    m_EventHead = (m_EventHead + 1) % EVENT_CAPACITY;
+    m_EventCount = std::min(m_EventCount + 1, EVENT_CAPACITY);
+    ++m_EventTotal;
+}
+
+std::vector<Profiler::Event> Profiler::getEvents(uint64_t first) {
+    // The i-th recorded event is at i % EVENT_CAPACITY, the ring starting at 0
+    first = std::max(first, m_EventTotal - m_EventCount);
+    std::vector<Event> events;
+    events.reserve(m_EventTotal - first);
+    for(uint64_t i = first; i < m_EventTotal; ++i) {
+        events.push_back(m_Events[i % EVENT_CAPACITY]);
+    }
+    return events;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if(!file) {
+        return false;
+    }
+    // Complete events ("X"), timestamps in microseconds; the metadata events name the two tracks
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"CPU\"}},\n", CPU_TRACK);
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"GPU\"}}", GPU_TRACK);
+    for(const Event& event : getEvents()) {
+        std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"frame\":%u}}",
+                     event.name, event.track == GPU_TRACK ? "gpu" : "cpu", event.start * 1e-3, event.duration * 1e-3,
+                     event.track, event.frame);
+    }
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+}
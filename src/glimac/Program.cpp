@@ -10,6 +10,23 @@ bool Program::link() {
 	return status == GL_TRUE;
 }
 
+bool Program::loadBinary(GLenum format, const void* data, GLsizei length) {
+	glProgramBinary(m_nGLId, format, data, length);
+	GLint status;
+	glGetProgramiv(m_nGLId, GL_LINK_STATUS, &status);
+	return status == GL_TRUE;
+}
+
+std::vector<char> Program::getBinary(GLenum& format) const {
+	GLint length = 0;
+	glGetProgramiv(m_nGLId, GL_PROGRAM_BINARY_LENGTH, &length);
+	std::vector<char> binary(length);
+	if(length > 0) {
+		glGetProgramBinary(m_nGLId, length, nullptr, &format, binary.data());
+	}
+	return binary;
+}
+
 const std::string Program::getInfoLog() const {
 	GLint length;
 	glGetProgramiv(m_nGLId, GL_INFO_LOG_LENGTH, &length);
@@ -21,7 +38,7 @@ const std::string Program::getInfoLog() const {
 }
 
 // Build a GLSL program from source code
-Program buildProgram(const GLchar* vsSrc, const GLchar* fsSrc) {
+Program buildProgram(const GLchar* vsSrc, const GLchar* fsSrc, bool binaryRetrievable) {
 	Shader vs(GL_VERTEX_SHADER);
 	vs.setSource(vsSrc);
 
@@ -39,6 +56,9 @@ Program buildProgram(const GLchar* vsSrc, const GLchar* fsSrc) {
 	Program program;
 	program.attachShader(vs);
 	program.attachShader(fs);
+	if(binaryRetrievable) {
+		program.setBinaryRetrievable();
+	}
 
 	if(!program.link()) {
 		throw std::runtime_error("Link error: " + program.getInfoLog());
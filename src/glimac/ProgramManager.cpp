@@ -0,0 +1,175 @@
+#include "glimac/ProgramManager.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <direct.h>
+#endif
+
+namespace glimac {
+
+namespace {
+
+const uint32_t BINARY_MAGIC = 0x42504c47; // "GLPB"
+const uint32_t BINARY_VERSION = 1;
+
+struct BinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t hash;
+    uint64_t driverHash;
+    uint32_t format;
+    uint32_t length;
+};
+
+// Binaries are only valid for the driver that produced them
+uint64_t driverHash() {
+    std::string driver;
+    for(auto name: { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        auto str = glGetString(name);
+        if(str) {
+            driver += reinterpret_cast<const char*>(str);
+        }
+        driver += '\n';
+    }
+    return hashString(driver);
+}
+
+bool binaryCacheSupported() {
+    if(!GLEW_ARB_get_program_binary) {
+        return false;
+    }
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+}
+
+std::string injectDefines(const std::string& src, const std::string& defines) {
+    if(defines.empty()) {
+        return src;
+    }
+    // #version must stay the first directive of the shader
+    size_t pos = 0;
+    if(src.compare(0, 8, "#version") == 0) {
+        pos = src.find('\n');
+        pos = (pos == std::string::npos) ? src.size() : pos + 1;
+    }
+    return src.substr(0, pos) + defines + (defines.back() == '\n' ? "" : "\n") + src.substr(pos);
+}
+
+FilePath binaryPath(const FilePath& directory, uint64_t hash) {
+    std::stringstream name;
+    name << std::hex << hash << ".bin";
+    return directory + name.str();
+}
+
+}
+
+uint64_t hashString(const std::string& str, uint64_t hash) {
+    for(auto c: str) {
+        hash ^= (unsigned char) c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::unordered_map<uint64_t, std::unique_ptr<Program>> ProgramManager::m_ProgramMap;
+FilePath ProgramManager::m_CacheDirectory;
+
+void ProgramManager::setCacheDirectory(const FilePath& directory) {
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+    m_CacheDirectory = directory;
+}
+
+const Program& ProgramManager::loadProgram(const FilePath& vsFile, const FilePath& fsFile, const std::string& defines) {
+    std::string vsSrc = injectDefines(loadShaderSource(vsFile), defines);
+    std::string fsSrc = injectDefines(loadShaderSource(fsFile), defines);
+    uint64_t hash = hashString(fsSrc, hashString(std::string(1, '\0'), hashString(vsSrc)));
+
+    auto it = m_ProgramMap.find(hash);
+    if(it != std::end(m_ProgramMap)) {
+        return *(*it).second;
+    }
+
+    bool useCache = !m_CacheDirectory.empty() && binaryCacheSupported();
+    std::unique_ptr<Program> pProgram;
+    if(useCache) {
+        pProgram = loadCachedProgram(hash);
+    }
+    if(!pProgram) {
+        try {
+            pProgram.reset(new Program(buildProgram(vsSrc.c_str(), fsSrc.c_str(), useCache)));
+        } catch(const std::runtime_error& e) {
+            throw std::runtime_error(std::string(e.what()) + " (for files " + vsFile.str() + " and " + fsFile.str() + ")");
+        }
+        if(useCache) {
+            storeCachedProgram(hash, *pProgram);
+        }
+    }
+
+    auto& program = m_ProgramMap[hash] = std::move(pProgram);
+    return *program;
+}
+
+void ProgramManager::clear() {
+    m_ProgramMap.clear();
+}
+
+std::unique_ptr<Program> ProgramManager::loadCachedProgram(uint64_t hash) {
+    std::ifstream input(binaryPath(m_CacheDirectory, hash).c_str(), std::ios::binary);
+    if(!input) {
+        return std::unique_ptr<Program>();
+    }
+
+    BinaryHeader header;
+    if(!input.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || header.magic != BINARY_MAGIC || header.version != BINARY_VERSION
+        || header.hash != hash || header.driverHash != driverHash()) {
+        return std::unique_ptr<Program>();
+    }
+
+    std::vector<char> binary(header.length);
+    if(!input.read(binary.data(), binary.size())) {
+        return std::unique_ptr<Program>();
+    }
+
+    std::unique_ptr<Program> pProgram(new Program());
+    if(!pProgram->loadBinary(header.format, binary.data(), binary.size())) {
+        // Rejected by the driver (e.g. after an update): recompile from sources
+        return std::unique_ptr<Program>();
+    }
+    return pProgram;
+}
+
+void ProgramManager::storeCachedProgram(uint64_t hash, const Program& program) {
+    GLenum format = 0;
+    std::vector<char> binary = program.getBinary(format);
+    if(binary.empty()) {
+        return;
+    }
+
+    BinaryHeader header;
+    header.magic = BINARY_MAGIC;
+    header.version = BINARY_VERSION;
+    header.hash = hash;
+    header.driverHash = driverHash();
+    header.format = format;
+    header.length = binary.size();
+
+    FilePath path = binaryPath(m_CacheDirectory, hash);
+    std::ofstream output(path.c_str(), std::ios::binary);
+    if(!output.write(reinterpret_cast<const char*>(&header), sizeof(header))
+        || !output.write(binary.data(), binary.size())) {
+        std::cerr << "unable to write program binary " << path << std::endl;
+    }
+}
+
+}
@@ -0,0 +1,126 @@
+#include "glimac/RenderQueue.hpp"
+#include "glimac/GLState.hpp"
+#include "glimac/Profiler.hpp"
+
+namespace glimac {
+
+namespace {
+
+const size_t DATA_ALIGNMENT = 16;
+
+// Profiler scope of the untagged items of each pass, indexed by RenderPass
+const char* const PASS_NAMES[] = { "pass background", "pass opaque" };
+
+}
+
+uint64_t makeSortKey(RenderPass pass, GLuint program, GLuint vao, GLuint texture, float depth) {
+    uint64_t depthBits = uint64_t(glm::clamp(depth, 0.f, 1.f) * float(0xFFFFFF));
+    return (uint64_t(pass & 0xF) << 60) | (uint64_t(program & 0xFFF) << 48)
+         | (uint64_t(vao & 0xFFF) << 36) | (uint64_t(texture & 0xFFF) << 24) | depthBits;
+}
+
+void RenderQueue::submit(RenderItem item, RenderPass pass, float depth) {
+    item.key = makeSortKey(pass, item.program, item.vao, item.texture, depth);
+    if(!item.stage) {
+        item.stage = m_Stage;
+    }
+    m_Items.push_back(item);
+}
+
+size_t RenderQueue::allocateData(size_t size) {
+    size_t offset = (m_Data.size() + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+    m_Data.resize(offset + size);
+    return offset;
+}
+
+void RenderQueue::sort() {
+    const size_t count = m_Items.size();
+    m_Order.resize(count);
+    m_Scratch.resize(count);
+    for(size_t i = 0; i < count; ++i) {
+        m_Order[i] = i;
+    }
+
+    // LSD radix sort on the key bytes, bytes shared by every key are skipped
+    uint64_t same = ~uint64_t(0), first = count ? m_Items[0].key : 0;
+    for(const auto& item: m_Items) {
+        same &= ~(item.key ^ first);
+    }
+    for(unsigned shift = 0; shift < 64; shift += 8) {
+        if(((same >> shift) & 0xFF) == 0xFF) {
+            continue;
+        }
+        size_t histogram[257] = { 0 };
+        for(size_t i = 0; i < count; ++i) {
+            ++histogram[((m_Items[m_Order[i]].key >> shift) & 0xFF) + 1];
+        }
+        for(size_t b = 1; b < 257; ++b) {
+            histogram[b] += histogram[b - 1];
+        }
+        for(size_t i = 0; i < count; ++i) {
+            m_Scratch[histogram[(m_Items[m_Order[i]].key >> shift) & 0xFF]++] = m_Order[i];
+        }
+        m_Order.swap(m_Scratch);
+    }
+}
+
+void RenderQueue::execute() {
+    if(m_Order.size() != m_Items.size()) {
+        sort();
+    }
+    // Consecutive items share most of their state, GLState skips what is already in place
+    int pass = -1;
+    const char* stage = nullptr;
+    for(auto index: m_Order) {
+        const RenderItem& item = m_Items[index];
+        // Each run of items of a same pass and stage is timed on the GPU
+        int itemPass = int(item.key >> 60);
+        if(itemPass != pass || item.stage != stage) {
+            if(pass >= 0) {
+                Profiler::end();
+            }
+            pass = itemPass;
+            stage = item.stage;
+            Profiler::begin(stage ? stage : PASS_NAMES[pass], true);
+        }
+        GLState::setEnabled(GL_DEPTH_TEST, item.depthTest);
+        GLState::useProgram(item.program);
+        GLState::bindVertexArray(item.vao);
+        if(item.textureTarget) {
+            GLState::bindTexture(item.textureUnit, item.textureTarget, item.texture);
+        }
+        if(item.callback) {
+            item.callback(&m_Data[item.dataOffset]);
+        }
+
+        if(item.indirectBuffer) {
+            GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, item.indirectBuffer);
+            glMultiDrawElementsIndirect(item.mode, item.indexType, (const GLvoid*)(item.first), item.count, 0);
+        } else if(item.indexType) {
+            const GLvoid* offset = (const GLvoid*)(item.first);
+            if(item.instanceCount) {
+                glDrawElementsInstancedBaseVertex(item.mode, item.count, item.indexType, offset, item.instanceCount, item.baseVertex);
+            } else {
+                glDrawElementsBaseVertex(item.mode, item.count, item.indexType, offset, item.baseVertex);
+            }
+        } else {
+            if(item.instanceCount) {
+                glDrawArraysInstanced(item.mode, item.first, item.count, item.instanceCount);
+            } else {
+                glDrawArrays(item.mode, item.first, item.count);
+            }
+        }
+    }
+    if(pass >= 0) {
+        Profiler::end();
+    }
+}
+
+void RenderQueue::clear() {
+    m_Items.clear();
+    m_Order.clear();
+    m_Data.clear();
+    m_Stage = nullptr;
+}
+
+}
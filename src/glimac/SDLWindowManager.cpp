@@ -1,45 +1,180 @@
 #include "glimac/SDLWindowManager.hpp"
 #include <iostream>
+#include <cstring>
+
+#ifdef GLIMAC_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 namespace glimac {
 
-SDLWindowManager::SDLWindowManager(uint32_t width, uint32_t height, const char* title) {
+SDLWindowManager::SDLWindowManager(uint32_t width, uint32_t height, const char* title):
+    m_Width(width), m_Height(height), m_Headless(false), m_Valid(false),
+    m_Display(nullptr), m_Context(nullptr), m_Framebuffer(0), m_ColorBuffer(0), m_DepthBuffer(0) {
+    openWindow(title);
+}
+
+SDLWindowManager::SDLWindowManager(uint32_t width, uint32_t height, const char* title, bool headless):
+    m_Width(width), m_Height(height), m_Headless(headless), m_Valid(false),
+    m_Display(nullptr), m_Context(nullptr), m_Framebuffer(0), m_ColorBuffer(0), m_DepthBuffer(0) {
+    if(headless) {
+        createHeadlessContext();
+    } else {
+        openWindow(title);
+    }
+}
+
+void SDLWindowManager::openWindow(const char* title) {
     if(0 != SDL_Init(SDL_INIT_VIDEO)) {
         std::cerr << SDL_GetError() << std::endl;
         return;
     }
-    if(!SDL_SetVideoMode(width, height, 32, SDL_OPENGL)) {
+    if(!SDL_SetVideoMode(m_Width, m_Height, 32, SDL_OPENGL)) {
         std::cerr << SDL_GetError() << std::endl;
         return;
     }
     SDL_WM_SetCaption(title, nullptr);
+    m_Valid = true;
+}
+
+void SDLWindowManager::createHeadlessContext() {
+    // SDL only provides the timer
+    if(0 != SDL_Init(SDL_INIT_TIMER)) {
+        std::cerr << SDL_GetError() << std::endl;
+        return;
+    }
+
+#ifdef GLIMAC_EGL
+    // Mesa's surfaceless platform needs neither X nor a GPU device node, otherwise the default display
+    EGLDisplay display = EGL_NO_DISPLAY;
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if(clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if(getPlatformDisplay) {
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+    }
+    if(display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if(display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        std::cerr << "EGL: no display" << std::endl;
+        return;
+    }
+    m_Display = display;
+
+    const EGLint configAttribs[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    eglChooseConfig(display, configAttribs, &config, 1, &configCount);
+    if(!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL: desktop OpenGL not supported" << std::endl;
+        return;
+    }
+    // No default VAO nor client arrays are used, a core context is enough
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, configCount ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+    if(context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "EGL: cannot create a surfaceless OpenGL 3.3 context" << std::endl;
+        return;
+    }
+    m_Context = context;
+
+    // glewInit() also looks for a GLX display, which does not exist here
+    glewExperimental = GL_TRUE;
+    GLenum glewError = glewContextInit();
+    if(GLEW_OK != glewError) {
+        std::cerr << glewGetErrorString(glewError) << std::endl;
+        return;
+    }
+
+    // Offscreen framebuffer standing for the window
+    glGenRenderbuffers(1, &m_ColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_ColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_Width, m_Height);
+    glGenRenderbuffers(1, &m_DepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_DepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, m_Width, m_Height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &m_Framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_DepthBuffer);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Headless framebuffer incomplete" << std::endl;
+        return;
+    }
+    // Without a surface the initial viewport is empty
+    glViewport(0, 0, m_Width, m_Height);
+    m_Valid = true;
+#else
+    std::cerr << "Headless mode unavailable: built without EGL" << std::endl;
+#endif
 }
 
 SDLWindowManager::~SDLWindowManager() {
+#ifdef GLIMAC_EGL
+    if(m_Context) {
+        glDeleteFramebuffers(1, &m_Framebuffer);
+        glDeleteRenderbuffers(1, &m_ColorBuffer);
+        glDeleteRenderbuffers(1, &m_DepthBuffer);
+        eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(m_Display, m_Context);
+    }
+    if(m_Display) {
+        eglTerminate(m_Display);
+    }
+#endif
     SDL_Quit();
 }
 
 bool SDLWindowManager::pollEvent(SDL_Event& e) {
+    if(m_Headless) {
+        return false;
+    }
     return SDL_PollEvent(&e);
 }
 
 bool SDLWindowManager::isKeyPressed(SDLKey key) const {
+    if(m_Headless) {
+        return false;
+    }
     return SDL_GetKeyState(nullptr)[key];
 }
 
 // button can SDL_BUTTON_LEFT, SDL_BUTTON_RIGHT and SDL_BUTTON_MIDDLE
 bool SDLWindowManager::isMouseButtonPressed(uint32_t button) const {
+    if(m_Headless) {
+        return false;
+    }
     return SDL_GetMouseState(nullptr, nullptr) & SDL_BUTTON(button);
 }
 
 glm::ivec2 SDLWindowManager::getMousePosition() const {
-    glm::ivec2 mousePos;
-    SDL_GetMouseState(&mousePos.x, &mousePos.y);
+    glm::ivec2 mousePos(0);
+    if(!m_Headless) {
+        SDL_GetMouseState(&mousePos.x, &mousePos.y);
+    }
     return mousePos;
 }
 
 void SDLWindowManager::swapBuffers() {
-    SDL_GL_SwapBuffers();
+    if(m_Headless) {
+        // Nothing to present, the frame stays in the framebuffer until the next one
+        glFlush();
+    } else {
+        SDL_GL_SwapBuffers();
+    }
 }
 
 float SDLWindowManager::getTime() const {
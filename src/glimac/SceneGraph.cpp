@@ -0,0 +1,145 @@
+#include <stdexcept>
+#include <cmath>
+#include "glimac/SceneGraph.hpp"
+#include "glimac/TransformBatch.hpp"
+
+namespace glimac {
+
+static float rotationAngle(double time, float speed) {
+    return float(std::fmod(time * speed, 2. * glm::pi<double>()));
+}
+
+SceneNode SceneGraph::addNode(SceneNode parent, const glm::vec3& translation, const glm::vec3& scale) {
+    SceneNode node = m_Parents.size();
+    if (parent != NO_PARENT && parent >= node) {
+        throw std::runtime_error("SceneGraph: a parent must be added before its children");
+    }
+    m_Parents.push_back(parent);
+    m_Depths.push_back(parent == NO_PARENT ? 0 : m_Depths[parent] + 1);
+    m_Translations.push_back(translation);
+    m_Scales.push_back(scale);
+    m_Tilts.push_back(glm::vec4(0.f, 1.f, 0.f, 0.f));
+    m_Orbits.push_back(glm::vec4(0.f, 1.f, 0.f, 0.f));
+    m_Spins.push_back(glm::vec4(0.f, 1.f, 0.f, 0.f));
+    m_StaticMatrices.push_back(glm::mat4(1.f));
+    m_LocalMatrices.push_back(glm::mat4(1.f));
+    m_WorldMatrices.push_back(glm::mat4(1.f));
+    m_Flags.push_back(STATIC_DIRTY | LOCAL_DIRTY);
+    return node;
+}
+
+void SceneGraph::setTranslation(SceneNode node, const glm::vec3& translation) {
+    m_Translations[node] = translation;
+    m_Flags[node] |= STATIC_DIRTY;
+}
+
+void SceneGraph::setScale(SceneNode node, const glm::vec3& scale) {
+    m_Scales[node] = scale;
+    m_Flags[node] |= STATIC_DIRTY;
+}
+
+void SceneGraph::setTilt(SceneNode node, float angle, const glm::vec3& axis) {
+    m_Tilts[node] = glm::vec4(axis, angle);
+    m_Flags[node] |= STATIC_DIRTY;
+}
+
+void SceneGraph::setOrbit(SceneNode node, const glm::vec3& axis, float speed) {
+    m_Orbits[node] = glm::vec4(axis, speed);
+    m_Flags[node] |= LOCAL_DIRTY;
+}
+
+void SceneGraph::setSpin(SceneNode node, const glm::vec3& axis, float speed) {
+    m_Spins[node] = glm::vec4(axis, speed);
+    m_Flags[node] |= LOCAL_DIRTY;
+}
+
+void SceneGraph::update(double time) {
+    bool timeChanged = (time != m_Time);
+    m_Time = time;
+    m_LocalNodes.clear();
+    m_OrbitAngles.clear();
+    m_SpinAngles.clear();
+    m_WorldNodes.clear();
+    m_DepthCounts.assign(1, 0);
+
+    // Gather pass. Parents come first: when a node is reached, the WORLD_CHANGED flag of its parent is final
+    for (size_t i = 0; i < m_Parents.size(); i++) {
+        std::uint8_t flags = m_Flags[i] & ~WORLD_CHANGED;
+        if (flags & STATIC_DIRTY) {
+            // Rare (only after a set*()), left scalar
+            glm::mat4 M = glm::translate(glm::mat4(1.f), m_Translations[i]);
+            M = glm::scale(M, m_Scales[i]);
+            if (m_Tilts[i].w != 0.f) {
+                M = glm::rotate(M, m_Tilts[i].w, glm::vec3(m_Tilts[i]));
+            }
+            m_StaticMatrices[i] = M;
+            flags |= LOCAL_DIRTY;
+        }
+        bool animated = (m_Orbits[i].w != 0.f || m_Spins[i].w != 0.f);
+        if ((flags & LOCAL_DIRTY) || (animated && timeChanged)) {
+            m_LocalNodes.push_back(i);
+            m_OrbitAngles.push_back(glm::vec4(glm::vec3(m_Orbits[i]), rotationAngle(time, m_Orbits[i].w)));
+            m_SpinAngles.push_back(glm::vec4(glm::vec3(m_Spins[i]), rotationAngle(time, m_Spins[i].w)));
+            flags |= WORLD_CHANGED;
+        }
+
+        SceneNode parent = m_Parents[i];
+        if (parent != NO_PARENT && (m_Flags[parent] & WORLD_CHANGED)) {
+            flags |= WORLD_CHANGED;
+        }
+        if (flags & WORLD_CHANGED) {
+            m_WorldNodes.push_back(i);
+            if (m_Depths[i] >= m_DepthCounts.size()) {
+                m_DepthCounts.resize(m_Depths[i] + 1, 0);
+            }
+            m_DepthCounts[m_Depths[i]]++;
+        }
+        m_Flags[i] = flags & WORLD_CHANGED;
+    }
+    m_UpdatedCount = m_WorldNodes.size();
+
+    size_t localCount = m_LocalNodes.size();
+    if (m_Sequence.size() < localCount) {
+        m_Sequence.resize(localCount);
+        for (size_t k = 0; k < m_Sequence.size(); k++) {
+            m_Sequence[k] = k;
+        }
+    }
+
+    // Local matrices: Orbit * Static * Spin (an angle of 0 gives an identity rotation)
+    m_OrbitRotations.resize(localCount);
+    m_SpinRotations.resize(localCount);
+    m_Products.resize(localCount);
+    rotationMatrices(m_OrbitAngles.data(), localCount, m_OrbitRotations.data());
+    rotationMatrices(m_SpinAngles.data(), localCount, m_SpinRotations.data());
+    multiplyAffine(m_StaticMatrices.data(), m_LocalNodes.data(), m_SpinRotations.data(), m_Sequence.data(),
+                   localCount, m_Products.data(), m_Sequence.data());
+    multiplyAffine(m_OrbitRotations.data(), m_Sequence.data(), m_Products.data(), m_Sequence.data(),
+                   localCount, m_LocalMatrices.data(), m_LocalNodes.data());
+
+    // World matrices, sorted by depth (stable, so still in topological order within a depth)
+    m_DepthOffsets.assign(m_DepthCounts.size() + 1, 0);
+    for (size_t d = 0; d < m_DepthCounts.size(); d++) {
+        m_DepthOffsets[d + 1] = m_DepthOffsets[d] + m_DepthCounts[d];
+        m_DepthCounts[d] = m_DepthOffsets[d]; // now the insertion cursor of the depth
+    }
+    m_SortedNodes.resize(m_WorldNodes.size());
+    m_WorldParents.resize(m_WorldNodes.size());
+    for (SceneNode node : m_WorldNodes) {
+        GLuint k = m_DepthCounts[m_Depths[node]]++;
+        m_SortedNodes[k] = node;
+        m_WorldParents[k] = m_Parents[node];
+    }
+    // Roots: world = local
+    for (GLuint k = m_DepthOffsets[0]; k < m_DepthOffsets[1]; k++) {
+        m_WorldMatrices[m_SortedNodes[k]] = m_LocalMatrices[m_SortedNodes[k]];
+    }
+    // Then each depth from the world matrices of the previous one
+    for (size_t d = 1; d + 1 < m_DepthOffsets.size(); d++) {
+        const SceneNode* nodes = m_SortedNodes.data() + m_DepthOffsets[d];
+        multiplyAffine(m_WorldMatrices.data(), m_WorldParents.data() + m_DepthOffsets[d], m_LocalMatrices.data(), nodes,
+                       m_DepthOffsets[d + 1] - m_DepthOffsets[d], m_WorldMatrices.data(), nodes);
+    }
+}
+
+}
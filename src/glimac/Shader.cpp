@@ -24,7 +24,7 @@ const std::string Shader::getInfoLog() const {
 	return logString;
 }
 
-Shader loadShader(GLenum type, const FilePath& filepath) {
+std::string loadShaderSource(const FilePath& filepath) {
     std::ifstream input(filepath.c_str());
     if(!input) {
         throw std::runtime_error("Unable to load the file " + filepath.str());
@@ -32,9 +32,12 @@ Shader loadShader(GLenum type, const FilePath& filepath) {
     
     std::stringstream buffer;
     buffer << input.rdbuf();
-    
+    return buffer.str();
+}
+
+Shader loadShader(GLenum type, const FilePath& filepath) {
     Shader shader(type);
-    shader.setSource(buffer.str().c_str());
+    shader.setSource(loadShaderSource(filepath).c_str());
 
     return shader;
 }
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cmath>
+#include "glimac/Simulation.hpp"
+#include "glimac/TransformBatch.hpp"
+
+namespace glimac {
+
+typedef std::chrono::steady_clock Clock;
+
+const unsigned int Simulation::MAX_CATCH_UP_STEPS;
+
+Simulation::Simulation(SceneGraph& scene, double step):
+    m_Scene(scene), m_Clock(step), m_TimeScale(1.), m_Running(false) {
+    // Initial state, readable before the thread has done its first step
+    m_Scene.update(0.);
+    SimulationState& state = m_States.getWriteBuffer();
+    state.tick = 0;
+    state.time = 0.;
+    state.step = step;
+    state.timeScale = 1.;
+    state.realTime = Clock::now();
+    copyWorldMatrices(state.current);
+    state.previous = state.current;
+    m_States.publish();
+}
+
+Simulation::~Simulation() {
+    stop();
+}
+
+void Simulation::start() {
+    if(!m_Running.exchange(true)) {
+        m_Thread = std::thread(&Simulation::run, this);
+    }
+}
+
+void Simulation::stop() {
+    m_Running.store(false);
+    if(m_Thread.joinable()) {
+        m_Thread.join();
+    }
+}
+
+void Simulation::copyWorldMatrices(std::vector<glm::mat4>& matrices) const {
+    matrices.resize(m_Scene.getNodeCount());
+    for(size_t i = 0; i < matrices.size(); ++i) {
+        matrices[i] = m_Scene.getWorldMatrix(i);
+    }
+}
+
+void Simulation::run() {
+    const double step = m_Clock.getStep();
+    std::vector<glm::mat4> previous, current;
+    copyWorldMatrices(current);
+    Clock::time_point last = Clock::now();
+    double accumulator = 0.;
+
+    while(m_Running.load(std::memory_order_relaxed)) {
+        Clock::time_point now = Clock::now();
+        double timeScale = getTimeScale();
+        accumulator += std::chrono::duration<double>(now - last).count() * timeScale;
+        last = now;
+
+        unsigned int steps = 0;
+        while(accumulator >= step && steps < MAX_CATCH_UP_STEPS) {
+            previous.swap(current);
+            m_Clock.advance();
+            m_Scene.update(m_Clock.getTime());
+            copyWorldMatrices(current);
+            accumulator -= step;
+            ++steps;
+        }
+        if(accumulator >= step) {
+            accumulator = std::fmod(accumulator, step);
+        }
+
+        if(steps > 0) {
+            SimulationState& state = m_States.getWriteBuffer();
+            state.tick = m_Clock.getTick();
+            state.time = m_Clock.getTime();
+            state.step = step;
+            state.timeScale = timeScale;
+            // The accumulator holds the simulated time already elapsed past the last step
+            state.realTime = now - std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(timeScale > 0. ? accumulator / timeScale : 0.));
+            state.previous = previous;
+            state.current = current;
+            m_States.publish();
+        }
+
+        // Until the next step is due (a whole step while paused)
+        double wait = (timeScale > 0.) ? (step - accumulator) / timeScale : step;
+        std::this_thread::sleep_for(std::chrono::duration<double>(std::min(wait, step)));
+    }
+}
+
+double Simulation::interpolate(std::vector<glm::mat4>& worldMatrices) {
+    m_States.update();
+    const SimulationState& state = m_States.getReadBuffer();
+    // previous -> current is shown during the step that follows current
+    double elapsed = std::chrono::duration<double>(Clock::now() - state.realTime).count() * state.timeScale;
+    float alpha = float(std::min(std::max(elapsed / state.step, 0.), 1.));
+    worldMatrices.resize(state.current.size());
+    for(size_t i = 0; i < worldMatrices.size(); ++i) {
+        worldMatrices[i] = interpolateSimilarity(state.previous[i], state.current[i], alpha);
+    }
+    return std::max(0., state.time - state.step + alpha * state.step);
+}
+
+}
@@ -3,6 +3,7 @@
 #include <iostream>
 #include "glimac/common.hpp"
 #include "glimac/Sphere.hpp"
+#include "glimac/MeshOptimizer.hpp"
 
 #include "c3ga/c3gaTools.hpp"
 
@@ -50,18 +51,24 @@ namespace glimac {
             }
         }
 
-        vertexCount = discLat * discLong * 6;
+        // Deux triangles par quad de la grille, les sommets sont partages via l'index buffer
+        std::vector<GLuint> quads;
         for(GLsizei j = 0; j < discLong; ++j) {
-            GLsizei offset = j * (discLat + 1);
+            GLuint offset = j * (discLat + 1);
             for(GLsizei i = 0; i < discLat; ++i) {
-                vertices.push_back(data[offset + i]);
-                vertices.push_back(data[offset + (i + 1)]);
-                vertices.push_back(data[offset + discLat + 1 + (i + 1)]);
-                vertices.push_back(data[offset + i]);
-                vertices.push_back(data[offset + discLat + 1 + (i + 1)]);
-                vertices.push_back(data[offset + i + discLat + 1]);
+                quads.push_back(offset + i);
+                quads.push_back(offset + (i + 1));
+                quads.push_back(offset + discLat + 1 + (i + 1));
+                quads.push_back(offset + i);
+                quads.push_back(offset + discLat + 1 + (i + 1));
+                quads.push_back(offset + i + discLat + 1);
             }
         }
+
+        vertices = data;
+        indices = quads;
+        optimizeMesh(vertices, indices);
+        vertexCount = vertices.size();
     }
 
     c3ga::Mvec<double> Sphere::sphere(float Rsphere) {
@@ -96,6 +103,18 @@ namespace glimac {
         return vertexCount;
     }
 
+    const GLuint* Sphere::getIndexPointer() const {
+        return &indices[0];
+    }
+
+    GLsizei Sphere::getIndexCount() const {
+        return indices.size();
+    }
+
+    std::vector<PackedShapeVertex> Sphere::getPackedData(VertexQuantization &quantization) const {
+        return packShapeVertices(vertices.data(), vertexCount, quantization);
+    }
+
     c3ga::Mvec<double> Sphere::getSphere() {
         return s;
     }
@@ -0,0 +1,109 @@
+#include <iostream>
+#include "glimac/StreamBuffer.hpp"
+#include "glimac/GLState.hpp"
+
+namespace glimac {
+
+// GL_COPY_WRITE_BUFFER is used to create and map the buffer so that no VAO or shadowed binding is touched
+static const GLenum STREAM_TARGET = GL_COPY_WRITE_BUFFER;
+
+StreamBuffer::StreamBuffer(GLsizeiptr frameSize, GLuint frameCount):
+    m_Buffer(0), m_FrameSize(frameSize), m_FrameCount(frameCount), m_Frame(0), m_Head(0),
+    m_Persistent(GLEW_ARB_buffer_storage), m_PersistentData(nullptr), m_Region(nullptr), m_Fences(frameCount, nullptr) {
+    create();
+}
+
+StreamBuffer::~StreamBuffer() {
+    destroy();
+}
+
+void StreamBuffer::create() {
+    glGenBuffers(1, &m_Buffer);
+    GLState::bindBuffer(STREAM_TARGET, m_Buffer);
+    if(m_Persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(STREAM_TARGET, m_FrameSize * m_FrameCount, nullptr, flags);
+        m_PersistentData = static_cast<char*>(glMapBufferRange(STREAM_TARGET, 0, m_FrameSize * m_FrameCount, flags));
+    } else {
+        glBufferData(STREAM_TARGET, m_FrameSize * m_FrameCount, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+void StreamBuffer::destroy() {
+    for(GLuint frame = 0; frame < m_FrameCount; ++frame) {
+        waitFence(frame);
+    }
+    unmap();
+    if(m_PersistentData) {
+        GLState::bindBuffer(STREAM_TARGET, m_Buffer);
+        glUnmapBuffer(STREAM_TARGET);
+        m_PersistentData = nullptr;
+    }
+    GLState::deleteBuffers(1, &m_Buffer);
+}
+
+void StreamBuffer::waitFence(GLuint frame) {
+    GLsync& fence = m_Fences[frame];
+    if(!fence) {
+        return;
+    }
+    // Normally already signaled: the region was last used frameCount - 1 frames ago
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while(glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED) {
+        flags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::beginFrame() {
+    unmap();
+    // The previous frame did not fit: grow before handing out the next region
+    if(m_Head > m_FrameSize) {
+        std::clog << "StreamBuffer: " << m_Head << " bytes needed per frame, growing from " << m_FrameSize << std::endl;
+        destroy();
+        while(m_FrameSize < m_Head) {
+            m_FrameSize *= 2;
+        }
+        create();
+    }
+
+    m_Frame = (m_Frame + 1) % m_FrameCount;
+    waitFence(m_Frame);
+    m_Head = 0;
+    if(m_Persistent) {
+        m_Region = m_PersistentData + m_Frame * m_FrameSize;
+    } else {
+        // Synchronization is done by the fences, the driver must not wait for the whole buffer
+        GLState::bindBuffer(STREAM_TARGET, m_Buffer);
+        m_Region = static_cast<char*>(glMapBufferRange(STREAM_TARGET, m_Frame * m_FrameSize, m_FrameSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    }
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+    GLsizeiptr start = (m_Head + alignment - 1) / alignment * alignment;
+    m_Head = start + size;
+    Allocation allocation;
+    allocation.offset = m_Frame * m_FrameSize + start;
+    allocation.data = (m_Region && m_Head <= m_FrameSize) ? m_Region + start : nullptr;
+    return allocation;
+}
+
+void StreamBuffer::unmap() {
+    if(m_Region && !m_Persistent) {
+        GLState::bindBuffer(STREAM_TARGET, m_Buffer);
+        glUnmapBuffer(STREAM_TARGET);
+    }
+    m_Region = nullptr;
+}
+
+void StreamBuffer::endFrame() {
+    unmap();
+    if(m_Fences[m_Frame]) {
+        glDeleteSync(m_Fences[m_Frame]);
+    }
+    m_Fences[m_Frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+}
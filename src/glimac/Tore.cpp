@@ -3,6 +3,7 @@
 #include <iostream>
 #include "glimac/common.hpp"
 #include "glimac/Tore.hpp"
+#include "glimac/MeshOptimizer.hpp"
 
 namespace glimac {
     // Constructeur: alloue le tableau de données et construit les attributs des vertex
@@ -52,18 +53,24 @@ namespace glimac {
             }
         }
 
-        vertexCount = nbi * nbe * 6;
+        // Deux triangles par quad de la grille, les sommets sont partages via l'index buffer
+        std::vector<GLuint> quads;
         for(GLsizei j = 0; j < nbe; ++j) {
-            GLsizei offset = j * (nbi + 1);
+            GLuint offset = j * (nbi + 1);
             for(GLsizei i = 0; i < nbi; ++i) {
-                vertices.push_back(data[offset + i]);
-                vertices.push_back(data[offset + (i + 1)]);
-                vertices.push_back(data[offset + nbi + 1 + (i + 1)]);
-                vertices.push_back(data[offset + i]);
-                vertices.push_back(data[offset + nbi + 1 + (i + 1)]);
-                vertices.push_back(data[offset + i + nbi + 1]);
+                quads.push_back(offset + i);
+                quads.push_back(offset + (i + 1));
+                quads.push_back(offset + nbi + 1 + (i + 1));
+                quads.push_back(offset + i);
+                quads.push_back(offset + nbi + 1 + (i + 1));
+                quads.push_back(offset + i + nbi + 1);
             }
         }
+
+        vertices = data;
+        indices = quads;
+        optimizeMesh(vertices, indices);
+        vertexCount = vertices.size();
     }
 
     const ShapeVertex* Tore::getDataPointer() const {
@@ -73,4 +80,16 @@ namespace glimac {
     GLsizei Tore::getVertexCount() const {
         return vertexCount;
     }
+
+    const GLuint* Tore::getIndexPointer() const {
+        return &indices[0];
+    }
+
+    GLsizei Tore::getIndexCount() const {
+        return indices.size();
+    }
+
+    std::vector<PackedShapeVertex> Tore::getPackedData(VertexQuantization &quantization) const {
+        return packShapeVertices(vertices.data(), vertexCount, quantization);
+    }
 }
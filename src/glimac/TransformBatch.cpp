@@ -0,0 +1,199 @@
+#include <cmath>
+#include "glimac/TransformBatch.hpp"
+#include <glm/gtc/quaternion.hpp>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace glimac {
+
+static const glm::mat4& matrixAt(const glm::mat4* matrices, size_t stride, size_t i) {
+    return *reinterpret_cast<const glm::mat4*>(reinterpret_cast<const char*>(matrices) + i * stride);
+}
+
+glm::mat4 interpolateSimilarity(const glm::mat4& a, const glm::mat4& b, float t) {
+    if(t <= 0.f) {
+        return a;
+    }
+    if(t >= 1.f) {
+        return b;
+    }
+    glm::vec3 scaleA(glm::length(glm::vec3(a[0])), glm::length(glm::vec3(a[1])), glm::length(glm::vec3(a[2])));
+    glm::vec3 scaleB(glm::length(glm::vec3(b[0])), glm::length(glm::vec3(b[1])), glm::length(glm::vec3(b[2])));
+    glm::mat3 rotationA(glm::vec3(a[0]) / scaleA.x, glm::vec3(a[1]) / scaleA.y, glm::vec3(a[2]) / scaleA.z);
+    glm::mat3 rotationB(glm::vec3(b[0]) / scaleB.x, glm::vec3(b[1]) / scaleB.y, glm::vec3(b[2]) / scaleB.z);
+    glm::quat rotation = glm::slerp(glm::quat_cast(rotationA), glm::quat_cast(rotationB), t);
+    glm::vec3 scale = glm::mix(scaleA, scaleB, t);
+
+    glm::mat4 result(glm::mat3_cast(rotation));
+    result[0] *= scale.x;
+    result[1] *= scale.y;
+    result[2] *= scale.z;
+    result[3] = glm::mix(a[3], b[3], t);
+    return result;
+}
+
+// Normalized axis, sine, cosine and 1 - cosine of an (axis, angle) pair
+static void rotationTerms(const glm::vec4& axisAngle, float* terms) {
+    glm::vec3 axis(axisAngle);
+    float length = glm::length(axis);
+    axis = (length > 0.f) ? axis / length : glm::vec3(0.f);
+    terms[0] = axis.x;
+    terms[1] = axis.y;
+    terms[2] = axis.z;
+    terms[3] = std::sin(axisAngle.w);
+    terms[4] = std::cos(axisAngle.w);
+    terms[5] = 1.f - terms[4];
+}
+
+void rotationMatrices(const glm::vec4* axisAngles, size_t count, glm::mat4* rotations) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+    for(; i + 4 <= count; i += 4) {
+        // terms[j][m]: term j of rotation i + m (structure of arrays)
+        alignas(16) float terms[6][4];
+        for(int m = 0; m < 4; ++m) {
+            float t[6];
+            rotationTerms(axisAngles[i + m], t);
+            for(int j = 0; j < 6; ++j) {
+                terms[j][m] = t[j];
+            }
+        }
+        __m128 x = _mm_load_ps(terms[0]), y = _mm_load_ps(terms[1]), z = _mm_load_ps(terms[2]);
+        __m128 s = _mm_load_ps(terms[3]), c = _mm_load_ps(terms[4]), tt = _mm_load_ps(terms[5]);
+        __m128 tx = _mm_mul_ps(tt, x), ty = _mm_mul_ps(tt, y), tz = _mm_mul_ps(tt, z);
+        __m128 sx = _mm_mul_ps(s, x), sy = _mm_mul_ps(s, y), sz = _mm_mul_ps(s, z);
+        __m128 txy = _mm_mul_ps(tx, y), txz = _mm_mul_ps(tx, z), tyz = _mm_mul_ps(ty, z);
+        // col[k][j]: component j of column k of the 4 matrices
+        __m128 col[4][4] = {
+            { _mm_add_ps(c, _mm_mul_ps(tx, x)), _mm_add_ps(txy, sz), _mm_sub_ps(txz, sy), zero },
+            { _mm_sub_ps(txy, sz), _mm_add_ps(c, _mm_mul_ps(ty, y)), _mm_add_ps(tyz, sx), zero },
+            { _mm_add_ps(txz, sy), _mm_sub_ps(tyz, sx), _mm_add_ps(c, _mm_mul_ps(tz, z)), zero },
+            { zero, zero, zero, one }
+        };
+        for(int k = 0; k < 4; ++k) {
+            _MM_TRANSPOSE4_PS(col[k][0], col[k][1], col[k][2], col[k][3]);
+            for(int m = 0; m < 4; ++m) {
+                _mm_storeu_ps(&rotations[i + m][k][0], col[k][m]);
+            }
+        }
+    }
+#endif
+
+    // Remaining matrices (or every matrix without SSE)
+    for(; i < count; ++i) {
+        float t[6];
+        rotationTerms(axisAngles[i], t);
+        glm::vec3 k(t[0], t[1], t[2]);
+        glm::mat4 R(1.f);
+        for(int column = 0; column < 3; ++column) {
+            glm::vec3 e(0.f);
+            e[column] = 1.f;
+            R[column] = glm::vec4(t[4] * e + t[3] * glm::cross(k, e) + t[5] * k[column] * k, 0.f);
+        }
+        rotations[i] = R;
+    }
+}
+
+void multiplyAffine(const glm::mat4* lefts, const GLuint* leftIndices, const glm::mat4* rights, const GLuint* rightIndices,
+                    size_t count, glm::mat4* results, const GLuint* resultIndices) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for(; i + 4 <= count; i += 4) {
+        // a[c][k], b[c][k]: component k of column c of the 4 left and right operands
+        __m128 a[4][4], b[4][4];
+        for(int c = 0; c < 4; ++c) {
+            for(int m = 0; m < 4; ++m) {
+                a[c][m] = _mm_loadu_ps(&lefts[leftIndices[i + m]][c][0]);
+                b[c][m] = _mm_loadu_ps(&rights[rightIndices[i + m]][c][0]);
+            }
+            _MM_TRANSPOSE4_PS(a[c][0], a[c][1], a[c][2], a[c][3]);
+            _MM_TRANSPOSE4_PS(b[c][0], b[c][1], b[c][2], b[c][3]);
+        }
+        // Column c of A * B: A3x3 * column c of B, plus the translation of A for the last column
+        __m128 r[4][4];
+        for(int c = 0; c < 4; ++c) {
+            for(int k = 0; k < 3; ++k) {
+                __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0][k], b[c][0]), _mm_mul_ps(a[1][k], b[c][1])), _mm_mul_ps(a[2][k], b[c][2]));
+                r[c][k] = (c == 3) ? _mm_add_ps(v, a[3][k]) : v;
+            }
+            r[c][3] = b[c][3];
+            _MM_TRANSPOSE4_PS(r[c][0], r[c][1], r[c][2], r[c][3]);
+        }
+        for(int c = 0; c < 4; ++c) {
+            for(int m = 0; m < 4; ++m) {
+                _mm_storeu_ps(&results[resultIndices[i + m]][c][0], r[c][m]);
+            }
+        }
+    }
+#endif
+
+    // Remaining products (or every product without SSE)
+    for(; i < count; ++i) {
+        results[resultIndices[i]] = lefts[leftIndices[i]] * rights[rightIndices[i]];
+    }
+}
+
+void transformBoundingSpheres(const glm::mat4* matrices, size_t stride, size_t count,
+                              const glm::vec3& center, float radius, BoundingSpheres& spheres, float* scales) {
+    spheres.resize(count);
+    float* x = spheres.x.data();
+    float* y = spheres.y.data();
+    float* z = spheres.z.data();
+    float* r = spheres.radius.data();
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+    const __m128 rad = _mm_set1_ps(radius);
+    for(; i + 4 <= count; i += 4) {
+        const float* m0 = &matrixAt(matrices, stride, i)[0][0];
+        const float* m1 = &matrixAt(matrices, stride, i + 1)[0][0];
+        const float* m2 = &matrixAt(matrices, stride, i + 2)[0][0];
+        const float* m3 = &matrixAt(matrices, stride, i + 3)[0][0];
+        // col[c][k]: component k of column c of the 4 matrices
+        __m128 col[4][4];
+        for(int c = 0; c < 4; ++c) {
+            col[c][0] = _mm_loadu_ps(m0 + 4 * c);
+            col[c][1] = _mm_loadu_ps(m1 + 4 * c);
+            col[c][2] = _mm_loadu_ps(m2 + 4 * c);
+            col[c][3] = _mm_loadu_ps(m3 + 4 * c);
+            _MM_TRANSPOSE4_PS(col[c][0], col[c][1], col[c][2], col[c][3]);
+        }
+        // Center: M * (center, 1)
+        __m128 wx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[0][0], cx), _mm_mul_ps(col[1][0], cy)), _mm_add_ps(_mm_mul_ps(col[2][0], cz), col[3][0]));
+        __m128 wy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[0][1], cx), _mm_mul_ps(col[1][1], cy)), _mm_add_ps(_mm_mul_ps(col[2][1], cz), col[3][1]));
+        __m128 wz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[0][2], cx), _mm_mul_ps(col[1][2], cy)), _mm_add_ps(_mm_mul_ps(col[2][2], cz), col[3][2]));
+        // Largest axis scale: lengths of the 3 first columns
+        __m128 scale2 = _mm_setzero_ps();
+        for(int c = 0; c < 3; ++c) {
+            __m128 l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[c][0], col[c][0]), _mm_mul_ps(col[c][1], col[c][1])), _mm_mul_ps(col[c][2], col[c][2]));
+            scale2 = _mm_max_ps(scale2, l2);
+        }
+        __m128 scale = _mm_sqrt_ps(scale2);
+        _mm_storeu_ps(x + i, wx);
+        _mm_storeu_ps(y + i, wy);
+        _mm_storeu_ps(z + i, wz);
+        _mm_storeu_ps(r + i, _mm_mul_ps(rad, scale));
+        _mm_storeu_ps(scales + i, scale);
+    }
+#endif
+
+    // Remaining matrices (or every matrix without SSE)
+    for(; i < count; ++i) {
+        const glm::mat4& M = matrixAt(matrices, stride, i);
+        glm::vec3 c = glm::vec3(M * glm::vec4(center, 1.f));
+        scales[i] = glm::sqrt(glm::max(glm::dot(glm::vec3(M[0]), glm::vec3(M[0])),
+                              glm::max(glm::dot(glm::vec3(M[1]), glm::vec3(M[1])), glm::dot(glm::vec3(M[2]), glm::vec3(M[2])))));
+        x[i] = c.x;
+        y[i] = c.y;
+        z[i] = c.z;
+        r[i] = radius * scales[i];
+    }
+}
+
+}
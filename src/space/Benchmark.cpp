@@ -0,0 +1,164 @@
+#include <cstdio>
+#include <cmath>
+#include <map>
+#include <algorithm>
+#include <iostream>
+#include <glimac/Profiler.hpp>
+#include <../include/space/Benchmark.hpp>
+
+using namespace glimac;
+
+// Points de controle : au-dessus du systeme, entre les planetes interieures, pres de Jupiter puis de Saturne,
+// au-dela de Neptune et retour (rayons des orbites : 16.5 a 135)
+const std::vector<glm::vec3> BENCHMARK_PATH = {
+    glm::vec3(2.4f, 94.f, -7.5f),
+    glm::vec3(45.f, 35.f, 40.f),
+    glm::vec3(22.f, 6.f, 18.f),
+    glm::vec3(-10.f, 3.f, 35.f),
+    glm::vec3(-60.f, 12.f, 20.f),
+    glm::vec3(-85.f, 20.f, -30.f),
+    glm::vec3(0.f, 45.f, -150.f),
+    glm::vec3(120.f, 60.f, -40.f)
+};
+
+CameraPath::CameraPath(const std::vector<glm::vec3> &points, const glm::vec3 &target) : points(points), target(target) {
+}
+
+glm::vec3 CameraPath::getPosition(float t) const {
+    // Segment i entre les points i et i + 1, interpole avec ses deux voisins
+    size_t n = points.size();
+    float u = (t - std::floor(t)) * n;
+    size_t i = std::min(size_t(u), n - 1);
+    float s = u - i;
+    const glm::vec3 &p0 = points[(i + n - 1) % n];
+    const glm::vec3 &p1 = points[i];
+    const glm::vec3 &p2 = points[(i + 1) % n];
+    const glm::vec3 &p3 = points[(i + 2) % n];
+    return 0.5f * ((2.f * p1) + (p2 - p0) * s + (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * s * s
+                   + (3.f * p1 - p0 - 3.f * p2 + p3) * s * s * s);
+}
+
+glm::mat4 CameraPath::getViewMatrix(float t) const {
+    return glm::lookAt(getPosition(t), target, glm::vec3(0, 1, 0));
+}
+
+Benchmark::Benchmark(unsigned int frameCount, unsigned int warmupFrames, float timeStep) :
+    path(BENCHMARK_PATH, glm::vec3(0)), frameCount(frameCount), warmupFrames(warmupFrames), timeStep(timeStep), endedFrames(0),
+    eventCursor(Profiler::getRecordedCount()), lostEvents(0) {
+    frameTimes.reserve(frameCount);
+}
+
+unsigned int Benchmark::getTotalFrames() const {
+    return warmupFrames + frameCount;
+}
+
+double Benchmark::getTime(unsigned int frame) const {
+    return frame * double(timeStep);
+}
+
+glm::mat4 Benchmark::getViewMatrix(unsigned int frame) const {
+    float t = (frame < warmupFrames) ? 0.f : float(frame - warmupFrames) / std::max(frameCount, 1u);
+    return path.getViewMatrix(t);
+}
+
+void Benchmark::endFrame() {
+    Clock::time_point now = Clock::now();
+    // La premiere frame mesuree commence a la fin de la derniere frame de chauffe
+    if (endedFrames >= warmupFrames && endedFrames > 0) {
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(now - lastFrameEnd).count());
+    }
+    endedFrames++;
+    collectEvents();
+    // Le cumul n'est pas compte dans le temps de la frame suivante
+    lastFrameEnd = Clock::now();
+}
+
+void Benchmark::collectEvents() {
+    // Une etape peut etre ouverte plusieurs fois par frame. Le Profiler numerote les frames a partir de 1 :
+    // la frame d'indice i est la frame i + 1, et les temps GPU arrivent quelques frames apres les temps CPU.
+    uint64_t recorded = Profiler::getRecordedCount();
+    if (recorded - eventCursor > Profiler::EVENT_CAPACITY) {
+        lostEvents += recorded - eventCursor - Profiler::EVENT_CAPACITY;
+    }
+    for (const Profiler::Event &event : Profiler::getEvents(eventCursor)) {
+        if (event.frame > warmupFrames) {
+            stageTimes[event.track][event.name][event.frame] += event.duration * 1e-6;
+        }
+    }
+    eventCursor = recorded;
+}
+
+// Statistiques d'une serie de mesures, en millisecondes (percentiles au rang le plus proche)
+struct Statistics {
+    size_t samples;
+    double mean, p50, p95, p99, max;
+};
+
+static Statistics computeStatistics(std::vector<double> values) {
+    Statistics stats = { values.size(), 0, 0, 0, 0, 0 };
+    if (values.empty()) {
+        return stats;
+    }
+    std::sort(values.begin(), values.end());
+    for (double value : values) {
+        stats.mean += value;
+    }
+    stats.mean /= values.size();
+    auto percentile = [&](double p) {
+        size_t rank = size_t(std::ceil(p / 100. * values.size()));
+        return values[std::max<size_t>(rank, 1) - 1];
+    };
+    stats.p50 = percentile(50);
+    stats.p95 = percentile(95);
+    stats.p99 = percentile(99);
+    stats.max = values.back();
+    return stats;
+}
+
+static void writeStatistics(std::FILE *file, const Statistics &stats) {
+    std::fprintf(file, "{\"samples\":%zu,\"mean\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f}",
+                 stats.samples, stats.mean, stats.p50, stats.p95, stats.p99, stats.max);
+}
+
+bool Benchmark::writeReport(const std::string &path) {
+    // Temps GPU des frames encore en vol
+    Profiler::flush();
+    collectEvents();
+    if (lostEvents > 0) {
+        std::cerr << "Benchmark : " << lostEvents << " evenements du Profiler perdus, temps des etapes incomplets" << std::endl;
+    }
+
+    std::FILE *file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    Statistics frameStats = computeStatistics(frameTimes);
+    std::fprintf(file, "{\n\"frames\":%u,\n\"warmup_frames\":%u,\n\"time_step\":%.6f,\n\"lost_events\":%llu,\n\"frame_time_ms\":",
+                 frameCount, warmupFrames, timeStep, (unsigned long long)lostEvents);
+    writeStatistics(file, frameStats);
+    const char *trackNames[2] = { "cpu_stages_ms", "gpu_stages_ms" };
+    for (int track = 0; track < 2; track++) {
+        std::fprintf(file, ",\n\"%s\":{", trackNames[track]);
+        bool first = true;
+        for (const auto &stage : stageTimes[track]) {
+            std::vector<double> times;
+            times.reserve(stage.second.size());
+            for (const auto &frame : stage.second) {
+                times.push_back(frame.second);
+            }
+            if (times.size() != frameCount) {
+                std::cerr << "Benchmark : etape " << (track == Profiler::GPU_TRACK ? "GPU " : "CPU ") << stage.first
+                          << " mesuree sur " << times.size() << " frames sur " << frameCount << std::endl;
+            }
+            std::fprintf(file, "%s\n  \"%s\":", first ? "" : ",", stage.first.c_str());
+            writeStatistics(file, computeStatistics(times));
+            first = false;
+        }
+        std::fprintf(file, "\n}");
+    }
+    std::fprintf(file, "\n}\n");
+
+    std::cout << "Benchmark : " << frameStats.samples << " frames, moyenne " << frameStats.mean << " ms, p50 " << frameStats.p50
+              << " ms, p95 " << frameStats.p95 << " ms, p99 " << frameStats.p99 << " ms" << std::endl;
+    return std::fclose(file) == 0;
+}
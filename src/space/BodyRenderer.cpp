@@ -0,0 +1,162 @@
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "glimac/common.hpp"
+#include "glimac/Profiler.hpp"
+#include <../include/space/BodyRenderer.hpp>
+
+// Attributs par instance : une mat4 occupe 4 locations consecutives
+const GLuint INSTANCE_ATTR_MODELMATRIX = 3;
+const GLuint INSTANCE_ATTR_LAYER = 7;
+
+// Valeurs par defaut : fenetre de 700 pixels de haut, erreur d'un demi pixel
+const GLfloat DEFAULT_VIEWPORT_HEIGHT = 700.f;
+const GLfloat DEFAULT_MAX_PIXEL_ERROR = 0.5f;
+
+BodyRenderer::BodyRenderer(const GeometryArena &geometry, const MeshHandle &mesh, const LodMesh &lod, StreamBuffer &stream) :
+    levelCounts(lod.getLevelCount(), 0), lod(lod), viewportHeight(DEFAULT_VIEWPORT_HEIGHT), maxPixelError(DEFAULT_MAX_PIXEL_ERROR),
+    mesh(mesh), stream(stream) {
+    // Les attributs d'instance font partie de l'etat du VAO : on garde le VAO de l'arena pour les
+    // dessins non instancies et on en cree un second, sur les memes buffers, pour les astres
+    glGenVertexArrays(1, &vao);
+    GLState::bindVertexArray(vao);
+
+    // Attributs de la sphere, lus dans les buffers de l'arena
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry.getIndexBuffer());
+    GLState::bindBuffer(GL_ARRAY_BUFFER, geometry.getVertexBuffer());
+    setShapeVertexAttribPointers(geometry.isPacked(), 0, 1, 2); // VERTEX_ATTR_POSITION, VERTEX_ATTR_NORMAL, VERTEX_ATTR_TEXCOORD
+
+    // Attributs par instance, avances une fois par astre (repointes a chaque dessin dans le stream buffer)
+    GLState::bindBuffer(GL_ARRAY_BUFFER, stream.getBuffer());
+    for (GLuint i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(INSTANCE_ATTR_MODELMATRIX + i);
+        glVertexAttribDivisor(INSTANCE_ATTR_MODELMATRIX + i, 1);
+    }
+    glEnableVertexAttribArray(INSTANCE_ATTR_LAYER);
+    glVertexAttribDivisor(INSTANCE_ATTR_LAYER, 1);
+    setInstanceAttribPointers(0);
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
+}
+
+void BodyRenderer::setInstanceAttribPointers(GLintptr offset) const {
+    for (GLuint i = 0; i < 4; i++) {
+        glVertexAttribPointer(INSTANCE_ATTR_MODELMATRIX + i, 4, GL_FLOAT, GL_FALSE, sizeof(BodyInstance),
+                              (const GLvoid*)(offset + offsetof(BodyInstance, ModelMatrix) + i * sizeof(glm::vec4)));
+    }
+    glVertexAttribPointer(INSTANCE_ATTR_LAYER, 1, GL_FLOAT, GL_FALSE, sizeof(BodyInstance), (const GLvoid*)(offset + offsetof(BodyInstance, layer)));
+}
+
+BodyRenderer::~BodyRenderer() {
+    GLState::deleteVertexArrays(1, &vao);
+}
+
+void BodyRenderer::setLodParameters(GLfloat viewportHeight, GLfloat maxPixelError) {
+    this->viewportHeight = viewportHeight;
+    this->maxPixelError = maxPixelError;
+}
+
+void BodyRenderer::clear() {
+    instances.clear();
+    visible.clear();
+}
+
+void BodyRenderer::addInstance(const glm::mat4 &ModelMatrix, GLfloat layer) {
+    BodyInstance instance;
+    instance.ModelMatrix = ModelMatrix;
+    instance.layer = layer;
+    instances.push_back(instance);
+}
+
+void BodyRenderer::submit(RenderQueue &queue, const InstancedTexProgram &program, GLuint textureArray, const CameraUniforms &camera) {
+    if (instances.empty()) {
+        return;
+    }
+
+    // Spheres englobantes dans le repere du monde (calculees 4 par 4), testees contre les plans de ViewProjMatrix
+    glm::vec3 center;
+    GLfloat radius;
+    boundingSphere(lod.getBoundingBox(), center, radius);
+    Profiler::begin("cull");
+    scales.resize(instances.size());
+    transformBoundingSpheres(&instances[0].ModelMatrix, sizeof(BodyInstance), instances.size(), center, radius, spheres, scales.data());
+    visible.clear();
+    cullSpheres(extractFrustum(camera.ViewProjMatrix), spheres, visible);
+    Profiler::end();
+    if (visible.empty()) {
+        return;
+    }
+
+    // Choix du niveau de chaque astre visible d'apres sa distance a la camera
+    const glm::mat4 &V = camera.ViewMatrix;
+    glm::vec3 eye = glm::vec3(similarityInverse(V)[3]); // la vue est une isometrie
+    glm::vec3 viewAxis(V[0][2], V[1][2], V[2][2]); // ligne z de la vue : profondeur d'un point du monde
+    GLfloat pixelsPerUnit = projectedPixelsPerUnit(camera.ProjMatrix, viewportHeight);
+    std::vector<GLsizei> levels(visible.size());
+    std::fill(levelCounts.begin(), levelCounts.end(), 0);
+    std::vector<GLfloat> levelDepths(levelCounts.size(), -std::numeric_limits<GLfloat>::max()); // z du plus proche
+    for (size_t v = 0; v < visible.size(); v++) {
+        GLuint i = visible[v];
+        glm::vec3 worldCenter(spheres.x[i], spheres.y[i], spheres.z[i]);
+        GLfloat distance = glm::length(worldCenter - eye) / scales[i] - radius;
+        levels[v] = lod.selectLevel(distance, pixelsPerUnit, maxPixelError);
+        levelCounts[levels[v]]++;
+        levelDepths[levels[v]] = glm::max(levelDepths[levels[v]], glm::dot(viewAxis, worldCenter) + V[3][2]);
+    }
+    // Regroupement des instances par niveau (tri par denombrement)
+    std::vector<GLsizei> firsts(levelCounts.size(), 0);
+    for (size_t l = 1; l < levelCounts.size(); l++) {
+        firsts[l] = firsts[l - 1] + levelCounts[l - 1];
+    }
+    sortedInstances.resize(visible.size());
+    for (size_t v = 0; v < visible.size(); v++) {
+        sortedInstances[firsts[levels[v]]++] = instances[visible[v]];
+    }
+
+    // Ecriture des instances dans la region de la frame, que le GPU n'utilise plus (aucune synchronisation)
+    StreamBuffer::Allocation allocation = stream.allocate(sortedInstances.size() * sizeof(BodyInstance));
+    if (!allocation.data) {
+        return; // region pleine : le stream buffer grandit a la frame suivante
+    }
+    std::memcpy(allocation.data, sortedInstances.data(), sortedInstances.size() * sizeof(BodyInstance));
+
+    // Un dessin par niveau utilise, les attributs d'instance sont decales sur sa plage
+    RenderItem item;
+    item.program = program.m_Program.getGLId();
+    item.vao = vao;
+    item.textureTarget = GL_TEXTURE_2D_ARRAY;
+    item.texture = textureArray;
+    item.textureUnit = TEXTURE_ARRAY_UNIT;
+    LevelDrawData data;
+    data.renderer = this;
+    data.program = &program;
+    GLsizei first = 0;
+    for (GLsizei l = 0; l < GLsizei(levelCounts.size()); l++) {
+        if (levelCounts[l] == 0) {
+            continue;
+        }
+        const LodLevel &level = lod.getLevel(l);
+        item.count = level.indexCount;
+        item.first = (mesh.firstIndex + level.firstIndex) * sizeof(GLuint);
+        item.baseVertex = mesh.baseVertex;
+        item.instanceCount = levelCounts[l];
+        data.offset = allocation.offset + first * sizeof(BodyInstance);
+        queue.submit(item, RENDER_PASS_OPAQUE, sortDepth(camera.ProjMatrix, levelDepths[l]), setLevelState, data);
+        first += levelCounts[l];
+    }
+}
+
+void BodyRenderer::setLevelState(const void *data) {
+    const LevelDrawData &level = *static_cast<const LevelDrawData*>(data);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, level.renderer->stream.getBuffer()); // deja lie apres le premier niveau
+    level.renderer->setInstanceAttribPointers(level.offset);
+    glUniform3fv(level.program->uPositionScale, 1, glm::value_ptr(level.renderer->mesh.quantization.scale));
+    glUniform3fv(level.program->uPositionBias, 1, glm::value_ptr(level.renderer->mesh.quantization.bias));
+}
+
+GLsizei BodyRenderer::getVisibleCount() const {
+    return visible.size();
+}
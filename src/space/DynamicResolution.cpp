@@ -0,0 +1,133 @@
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include "glimac/common.hpp"
+#include <glimac/GLState.hpp>
+#include <../include/space/DynamicResolution.hpp>
+
+// Unite de texture de la scene pendant l'agrandissement
+const GLuint SCENE_TEXTURE_UNIT = 0;
+
+DynamicResolution::DynamicResolution(GLsizei width, GLsizei height, GLfloat budget, GLfloat minScale, GLfloat maxScale) :
+    width(width), height(height), budget(budget), minScale(minScale), maxScale(maxScale), scale(maxScale),
+    sceneTime(0.f), frame(0) {
+    textureWidth = GLsizei(std::ceil(width * maxScale));
+    textureHeight = GLsizei(std::ceil(height * maxScale));
+
+    // Filtrage bilineaire pour l'agrandissement, pas de mipmaps
+    glGenTextures(1, &colorTexture);
+    GLState::bindTexture(SCENE_TEXTURE_UNIT, GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::bindTexture(SCENE_TEXTURE_UNIT, GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, textureWidth, textureHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Resolution dynamique : framebuffer incomplet" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &vao);
+    for (GLuint i = 0; i < FRAME_LATENCY; i++) {
+        glGenQueries(2, queries[i]);
+        pending[i] = false;
+    }
+}
+
+DynamicResolution::~DynamicResolution() {
+    for (GLuint i = 0; i < FRAME_LATENCY; i++) {
+        glDeleteQueries(2, queries[i]);
+    }
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    GLState::deleteTextures(1, &colorTexture);
+    GLState::deleteVertexArrays(1, &vao);
+}
+
+void DynamicResolution::updateScale() {
+    if (!pending[frame]) {
+        return;
+    }
+    pending[frame] = false;
+    // Toujours pas disponible apres FRAME_LATENCY frames : la mesure est abandonnee plutot qu'attendue
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(queries[frame][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return;
+    }
+    GLuint64 start = 0, end = 0;
+    glGetQueryObjectui64v(queries[frame][0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(queries[frame][1], GL_QUERY_RESULT, &end);
+    sceneTime = (end - start) * 1e-6f;
+    if (sceneTime <= 0.f) {
+        return;
+    }
+
+    // Le temps de la scene est a peu pres proportionnel au nombre de pixels, soit au carre de l'echelle
+    GLfloat target = scale * std::sqrt(budget / sceneTime);
+    // Zone morte pour ne pas osciller autour du budget ; on descend vite et on remonte doucement
+    if (std::abs(target - scale) < 0.02f * scale) {
+        return;
+    }
+    target = std::min(std::max(target, 0.85f * scale), 1.05f * scale);
+    scale = std::min(std::max(target, minScale), maxScale);
+}
+
+void DynamicResolution::beginScene() {
+    // Requetes posees FRAME_LATENCY frames plus tot
+    frame = (frame + 1) % FRAME_LATENCY;
+    updateScale();
+
+    // Le scissor limite aussi l'effacement a la zone de rendu
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, getRenderWidth(), getRenderHeight());
+    GLState::enable(GL_SCISSOR_TEST);
+    glScissor(0, 0, getRenderWidth(), getRenderHeight());
+    glQueryCounter(queries[frame][0], GL_TIMESTAMP);
+}
+
+void DynamicResolution::endScene(GLuint output, const UpscaleProgram &program) {
+    glQueryCounter(queries[frame][1], GL_TIMESTAMP);
+    pending[frame] = true;
+    GLState::disable(GL_SCISSOR_TEST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, output);
+    glViewport(0, 0, width, height);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::useProgram(program.m_Program.getGLId());
+    GLState::bindVertexArray(vao);
+    GLState::bindTexture(SCENE_TEXTURE_UNIT, GL_TEXTURE_2D, colorTexture);
+    glUniform1i(program.uScene, SCENE_TEXTURE_UNIT);
+    glUniform2f(program.uUvScale, GLfloat(getRenderWidth()) / textureWidth, GLfloat(getRenderHeight()) / textureHeight);
+    glUniform2f(program.uTexelSize, 1.f / textureWidth, 1.f / textureHeight);
+    // Plus l'agrandissement est fort, plus les contours sont adoucis : nettete nulle a l'echelle 1
+    glUniform1f(program.uSharpness, std::min(0.25f, 0.5f * (1.f / scale - 1.f)));
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+GLfloat DynamicResolution::getScale() const {
+    return scale;
+}
+
+GLsizei DynamicResolution::getRenderWidth() const {
+    return std::max(1, GLsizei(std::lround(width * scale)));
+}
+
+GLsizei DynamicResolution::getRenderHeight() const {
+    return std::max(1, GLsizei(std::lround(height * scale)));
+}
+
+GLfloat DynamicResolution::getSceneTime() const {
+    return sceneTime;
+}
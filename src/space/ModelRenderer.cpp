@@ -0,0 +1,134 @@
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "glimac/common.hpp"
+#include <glimac/GLState.hpp>
+#include <../include/space/ModelRenderer.hpp>
+
+ModelRenderer::ModelRenderer(const Geometry &geometry) : bbox(geometry.getBoundingBox()) {
+    // Materiaux du modele, plus un materiau gris par defaut pour les sous-maillages qui n'en ont pas
+    std::vector<ModelMaterial> materials(geometry.getMaterialCount() + 1);
+    for (size_t i = 0; i < geometry.getMaterialCount(); i++) {
+        const Geometry::Material &m = geometry.getMaterialBuffer()[i];
+        materials[i].diffuse = glm::vec4(m.m_Kd, m.m_Dissolve);
+        materials[i].specular = glm::vec4(m.m_Ks, m.m_Shininess);
+        materials[i].emission = glm::vec4(m.m_Le, 0.f);
+    }
+    GLint defaultMaterial = geometry.getMaterialCount();
+    materials[defaultMaterial].diffuse = glm::vec4(0.8f, 0.8f, 0.8f, 1.f);
+    materials[defaultMaterial].specular = glm::vec4(0.f);
+    materials[defaultMaterial].emission = glm::vec4(0.f);
+
+    // Une commande par sous-maillage, triees par materiau pour que chaque materiau soit une plage continue
+    std::vector<const Geometry::Mesh*> meshes;
+    for (size_t i = 0; i < geometry.getMeshCount(); i++) {
+        meshes.push_back(&geometry.getMeshBuffer()[i]);
+    }
+    auto materialOf = [defaultMaterial](const Geometry::Mesh *mesh) {
+        return mesh->m_nMaterialIndex < 0 ? defaultMaterial : mesh->m_nMaterialIndex;
+    };
+    std::stable_sort(meshes.begin(), meshes.end(), [&materialOf](const Geometry::Mesh *a, const Geometry::Mesh *b) {
+        return materialOf(a) < materialOf(b);
+    });
+    std::vector<DrawElementsIndirectCommand> commands;
+    for (const Geometry::Mesh *mesh : meshes) {
+        if (mesh->m_nIndexCount == 0) {
+            continue;
+        }
+        GLint material = materialOf(mesh);
+        if (buckets.empty() || buckets.back().material != material) {
+            Bucket bucket;
+            bucket.material = material;
+            bucket.first = commands.size();
+            bucket.count = 0;
+            buckets.push_back(bucket);
+        }
+        buckets.back().count++;
+        DrawElementsIndirectCommand command;
+        command.count = mesh->m_nIndexCount;
+        command.instanceCount = 1;
+        command.firstIndex = mesh->m_nIndexOffset;
+        command.baseVertex = 0; // les indices de Geometry portent deja sur tout le vertex buffer
+        command.baseInstance = 0;
+        commands.push_back(command);
+    }
+
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ibo);
+    glGenBuffers(1, &indirectBuffer);
+    glGenBuffers(1, &materialBuffer);
+    glGenVertexArrays(1, &vao);
+
+    GLState::bindVertexArray(vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, geometry.getVertexCount() * sizeof(Geometry::Vertex), geometry.getVertexBuffer(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0); // VERTEX_ATTR_POSITION
+    glEnableVertexAttribArray(1); // VERTEX_ATTR_NORMAL
+    glEnableVertexAttribArray(2); // VERTEX_ATTR_TEXCOORD
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Geometry::Vertex), (const GLvoid*)(offsetof(Geometry::Vertex, m_Position)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Geometry::Vertex), (const GLvoid*)(offsetof(Geometry::Vertex, m_Normal)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Geometry::Vertex), (const GLvoid*)(offsetof(Geometry::Vertex, m_TexCoords)));
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, geometry.getIndexCount() * sizeof(GLuint), geometry.getIndexBuffer(), GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
+
+    GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, materialBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, materials.size() * sizeof(ModelMaterial), materials.data(), GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+ModelRenderer::~ModelRenderer() {
+    GLState::deleteBuffers(1, &vbo);
+    GLState::deleteBuffers(1, &ibo);
+    GLState::deleteBuffers(1, &indirectBuffer);
+    GLState::deleteBuffers(1, &materialBuffer);
+    GLState::deleteVertexArrays(1, &vao);
+}
+
+void ModelRenderer::submit(RenderQueue &queue, const ModelProgram &program, const glm::mat4 &ModelMatrix,
+                           const CameraUniforms &camera, const Frustum &frustum) {
+    glm::vec3 center;
+    GLfloat radius;
+    boundingSphere(bbox, center, radius);
+    GLfloat scale = glm::max(glm::length(glm::vec3(ModelMatrix[0])), glm::max(glm::length(glm::vec3(ModelMatrix[1])), glm::length(glm::vec3(ModelMatrix[2]))));
+    glm::vec3 worldCenter = glm::vec3(ModelMatrix * glm::vec4(center, 1));
+    if (!intersects(frustum, worldCenter, radius * scale)) {
+        return;
+    }
+    GLfloat depth = sortDepth(camera.ProjMatrix, (camera.ViewMatrix * glm::vec4(worldCenter, 1)).z);
+
+    RenderItem item;
+    item.program = program.m_Program.getGLId();
+    item.vao = vao;
+    item.indirectBuffer = indirectBuffer;
+    BucketDrawData data;
+    data.program = &program;
+    data.materialBuffer = materialBuffer;
+    data.ModelMatrix = ModelMatrix;
+    for (const Bucket &bucket : buckets) {
+        item.first = bucket.first * sizeof(DrawElementsIndirectCommand);
+        item.count = bucket.count;
+        data.material = bucket.material;
+        queue.submit(item, RENDER_PASS_OPAQUE, depth, setBucketState, data);
+    }
+}
+
+void ModelRenderer::setBucketState(const void *data) {
+    const BucketDrawData &bucket = *static_cast<const BucketDrawData*>(data);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_STORAGE_BINDING, bucket.materialBuffer);
+    glUniform1i(bucket.program->uMaterialIndex, bucket.material);
+    glUniformMatrix4fv(bucket.program->uModelMatrix, 1, GL_FALSE, glm::value_ptr(bucket.ModelMatrix));
+}
+
+const BBox3f& ModelRenderer::getBoundingBox() const {
+    return bbox;
+}
+
+GLsizei ModelRenderer::getDrawCount() const {
+    return buckets.size();
+}
@@ -0,0 +1,80 @@
+#include <cstddef>
+#include <vector>
+#include "glimac/common.hpp"
+#include <glimac/GLState.hpp>
+#include <../include/space/OrbitRenderer.hpp>
+
+// Attributs par instance (voir orbit.vs.glsl)
+const GLuint ORBIT_ATTR_ORBIT = 0;
+const GLuint ORBIT_ATTR_COLOR = 1;
+
+OrbitRenderer::OrbitRenderer(GLsizei segments) : segments(segments), dirty(false) {
+    glGenBuffers(1, &vboInstances);
+
+    // Pas de sommets : le shader calcule la boucle a partir de gl_VertexID, seules les orbites sont lues
+    glGenVertexArrays(1, &vao);
+    GLState::bindVertexArray(vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vboInstances);
+    glEnableVertexAttribArray(ORBIT_ATTR_ORBIT);
+    glEnableVertexAttribArray(ORBIT_ATTR_COLOR);
+    glVertexAttribPointer(ORBIT_ATTR_ORBIT, 4, GL_FLOAT, GL_FALSE, sizeof(OrbitInstance), (const GLvoid*)(offsetof(OrbitInstance, orbit)));
+    glVertexAttribPointer(ORBIT_ATTR_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(OrbitInstance), (const GLvoid*)(offsetof(OrbitInstance, color)));
+    glVertexAttribDivisor(ORBIT_ATTR_ORBIT, 1);
+    glVertexAttribDivisor(ORBIT_ATTR_COLOR, 1);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
+}
+
+OrbitRenderer::~OrbitRenderer() {
+    GLState::deleteBuffers(1, &vboInstances);
+    GLState::deleteVertexArrays(1, &vao);
+}
+
+void OrbitRenderer::addOrbit(GLfloat semiMajorAxis, GLfloat eccentricity, GLfloat inclination, GLfloat ascendingNode, const glm::vec4 &color) {
+    OrbitInstance instance;
+    instance.orbit = glm::vec4(semiMajorAxis, eccentricity, inclination, ascendingNode);
+    instance.color = color;
+    orbits.push_back(instance);
+    dirty = true;
+}
+
+void OrbitRenderer::clear() {
+    orbits.clear();
+    dirty = true;
+}
+
+void OrbitRenderer::submit(RenderQueue &queue, const OrbitProgram &program, const glm::mat4 &ModelMatrix) {
+    if (orbits.empty()) {
+        return;
+    }
+    // Les orbites sont fixes : un seul envoi tant qu'elles ne changent pas
+    if (dirty) {
+        GLState::bindBuffer(GL_ARRAY_BUFFER, vboInstances);
+        glBufferData(GL_ARRAY_BUFFER, orbits.size() * sizeof(OrbitInstance), orbits.data(), GL_STATIC_DRAW);
+        dirty = false;
+    }
+
+    RenderItem item;
+    item.program = program.m_Program.getGLId();
+    item.vao = vao;
+    item.mode = GL_LINE_LOOP;
+    item.indexType = 0;
+    item.count = segments;
+    item.instanceCount = orbits.size();
+    OrbitDrawData data;
+    data.program = &program;
+    data.ModelMatrix = ModelMatrix;
+    data.segments = segments;
+    // Les orbites traversent toute la scene : pas de profondeur representative
+    queue.submit(item, RENDER_PASS_OPAQUE, 0.f, setOrbitState, data);
+}
+
+void OrbitRenderer::setOrbitState(const void *data) {
+    const OrbitDrawData &orbit = *static_cast<const OrbitDrawData*>(data);
+    glUniformMatrix4fv(orbit.program->uModelMatrix, 1, GL_FALSE, glm::value_ptr(orbit.ModelMatrix));
+    glUniform1i(orbit.program->uSegments, orbit.segments);
+}
+
+GLsizei OrbitRenderer::getOrbitCount() const {
+    return orbits.size();
+}
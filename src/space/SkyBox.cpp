@@ -3,87 +3,81 @@
 #include <iostream>
 #include <glimac/Image.hpp>
 #include "glimac/common.hpp"
-#include "../src/glimac/stb_image.h"
 #include "../include/glimac/Cube.hpp"
 #include <../include/space/SkyBox.hpp>
 
-SkyBox::SkyBox(const GLsizei count_vertex_skybox, const ShapeVertex *verticesSkybox) {
-    buildSkyBox(count_vertex_skybox, verticesSkybox);
+SkyBox::SkyBox(GeometryArena &geometry, const GLsizei count_vertex_skybox, const ShapeVertex *verticesSkybox, const GLsizei count_index_skybox, const GLuint *indicesSkybox) {
+    buildSkyBox(geometry, count_vertex_skybox, verticesSkybox, count_index_skybox, indicesSkybox);
 }
 
 SkyBox::~SkyBox() {}
 
-void SkyBox::buildSkyBox(const GLsizei count_vertex_skybox, const ShapeVertex *verticesSkybox) {
-	/// Bind VBO for skybox
-    //GLuint vbo;
-    glGenBuffers(1, &vbo);
-    // Binding d'un VBO sur la cible GL_ARRAY_BUFFER:
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, count_vertex_skybox * sizeof(ShapeVertex), verticesSkybox, GL_STATIC_DRAW); // Envoi des données
-    //Après avoir modifié le VBO, on le débind de la cible pour éviter de le remodifier par erreur
-    glBindBuffer(GL_ARRAY_BUFFER, 0); // debind
-    /// Bind VAO for skybox
-    //GLuint vao;
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glEnableVertexAttribArray(0); // VERTEX_ATTR_POSITION
-    glEnableVertexAttribArray(1); // VERTEX_ATTR_NORMAL
-    glEnableVertexAttribArray(2); // VERTEX_ATTR_TEXT
-    // VERTEX_ATTR_POSITION
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid*)(offsetof(ShapeVertex, position)));
-    // VERTEX_ATTR_NORMAL
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid*)(offsetof(ShapeVertex, normal)));
-    // VERTEX_ATTR_TEXT
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid*)(offsetof(ShapeVertex, texCoords)));
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+void SkyBox::buildSkyBox(GeometryArena &geometry, const GLsizei count_vertex_skybox, const ShapeVertex *verticesSkybox, const GLsizei count_index_skybox, const GLuint *indicesSkybox) {
+    // Le cube partage le VBO, l'IBO et le VAO des autres maillages statiques
+    this->geometry = &geometry;
+    mesh = geometry.add(verticesSkybox, count_vertex_skybox, indicesSkybox, count_index_skybox);
 }
 
-unsigned int SkyBox::loadCubemap(std::vector<std::string> faces) {
+unsigned int SkyBox::createCubemap() {
     unsigned int textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++) {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data) {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
-        else {
-            std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
-        }
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    // Faces noires de 1x1 en attendant les images
+    const GLubyte black[4] = { 0, 0, 0, 255 };
+    for (unsigned int i = 0; i < 6; i++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_SRGB8_ALPHA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, black);
     }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    Texture::setMipmapFiltering(GL_TEXTURE_CUBE_MAP);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     return textureID;
 }
 
-void SkyBox::activeSkyBox(const Skytext &skytext, const GLuint &cubemapTexture, float distRendu, float ratio_h_w, glm::mat4 VMatrix) {
-    glBindVertexArray(vao);
-
-    glm::mat4 MVMatrix, ProjMatrix, MVPMatrix, NormalMatrix;
-    glDisable(GL_DEPTH_TEST);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-    skytext.m_Program.use();
-    // ... définir la matrice de vue et projection
-    ProjMatrix = glm::perspective(glm::radians(70.f), ratio_h_w, 0.1f, distRendu);
-    MVMatrix = glm::mat4(glm::mat3(VMatrix)); // Remove translation from the MV
-    MVPMatrix = ProjMatrix * MVMatrix;
-    glUniformMatrix4fv(skytext.uMVP, 1, GL_FALSE, glm::value_ptr(MVPMatrix));
+void SkyBox::uploadCubemap(unsigned int textureID, const std::vector<std::unique_ptr<Image>> &faces) {
+    // Les six faces d'une cubemap doivent avoir la meme taille : une face manquante garde les faces noires
+    if (faces.size() != 6) {
+        return;
+    }
+    for (const std::unique_ptr<Image> &face : faces) {
+        if (!face || face->getWidth() != faces[0]->getWidth() || face->getHeight() != faces[0]->getHeight()
+            || face->getFormat() != faces[0]->getFormat()) {
+            return;
+        }
+    }
+    GLenum internalFormat, pixelFormat, type;
+    Texture::getGLFormat(faces[0]->getFormat(), internalFormat, pixelFormat, type);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (unsigned int i = 0; i < faces.size(); i++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internalFormat, faces[i]->getWidth(), faces[i]->getHeight(), 0,
+                     pixelFormat, type, faces[i]->getData());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // Mipmaps generees par le GPU, filtrees en lineaire pour les faces sRGB
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+}
 
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-    glEnable(GL_DEPTH_TEST);
-    glBindVertexArray(0);
-    //debindage de la texture
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+void SkyBox::activeSkyBox(RenderQueue &queue, const Skytext &skytext, const GLuint &cubemapTexture) {
+    // La vue et la projection sont lues dans le bloc Camera, seul le decodage des positions est propre a la skybox
+    RenderItem item;
+    item.program = skytext.m_Program.getGLId();
+    item.vao = geometry->getVertexArray();
+    item.textureTarget = GL_TEXTURE_CUBE_MAP;
+    item.texture = cubemapTexture;
+    item.textureUnit = 0;
+    item.depthTest = GL_FALSE;
+    item.count = mesh.indexCount;
+    item.first = mesh.firstIndex * sizeof(GLuint);
+    item.baseVertex = mesh.baseVertex;
+    SkyBoxDrawData data;
+    data.program = &skytext;
+    data.quantization = mesh.quantization;
+    queue.submit(item, RENDER_PASS_BACKGROUND, 0.f, setSkyBoxState, data);
+}
 
-    glBindVertexArray(0);
-}
\ No newline at end of file
+void SkyBox::setSkyBoxState(const void *data) {
+    const SkyBoxDrawData &skybox = *static_cast<const SkyBoxDrawData*>(data);
+    glUniform3fv(skybox.program->uPositionScale, 1, glm::value_ptr(skybox.quantization.scale));
+    glUniform3fv(skybox.program->uPositionBias, 1, glm::value_ptr(skybox.quantization.bias));
+}
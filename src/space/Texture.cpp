@@ -1,20 +1,115 @@
 #include <cmath>
 #include <vector>
 #include <iostream>
+#include <algorithm>
 #include "glimac/common.hpp"
 #include <../include/space/Texture.hpp>
 
 void Texture::firstBindTexture(std::unique_ptr<Image> &texLoad, GLuint texture) {
+    GLenum internalFormat, pixelFormat, type;
+    getGLFormat(texLoad->getFormat(), internalFormat, pixelFormat, type);
     //Binding de la texture 
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texLoad->getWidth(), texLoad->getHeight(), 0, GL_RGBA, GL_FLOAT, texLoad->getPixels());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GLState::bindTexture(GL_TEXTURE_2D, texture);
+    // Lignes RGB sans alignement sur 4 octets
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (unsigned int level = 0; level < texLoad->getLevelCount(); level++) {
+        const Image &image = texLoad->getLevel(level);
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, image.getWidth(), image.getHeight(), 0, pixelFormat, type, image.getData());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (texLoad->getLevelCount() > 1) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texLoad->getLevelCount() - 1);
+    }
+    else {
+        // Pas de mipmaps precalculees : generees par le GPU
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    setMipmapFiltering(GL_TEXTURE_2D);
     //debindage de la texture
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture::getGLFormat(PixelFormat format, GLenum &internalFormat, GLenum &pixelFormat, GLenum &type) {
+    type = GL_UNSIGNED_BYTE;
+    switch (format) {
+        case PixelFormat::RGBA8: internalFormat = GL_RGBA8; pixelFormat = GL_RGBA; break;
+        case PixelFormat::RGB8: internalFormat = GL_RGB8; pixelFormat = GL_RGB; break;
+        case PixelFormat::SRGB8: internalFormat = GL_SRGB8; pixelFormat = GL_RGB; break;
+        case PixelFormat::SRGB8_ALPHA8: internalFormat = GL_SRGB8_ALPHA8; pixelFormat = GL_RGBA; break;
+        default: internalFormat = GL_RGBA; pixelFormat = GL_RGBA; type = GL_FLOAT; break;
+    }
+}
+
+void Texture::setMipmapFiltering(GLenum target) {
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Extension EXT seule : GLEW_ARB_texture_filter_anisotropic (memes enums) n'existe qu'a partir de GLEW 2.1
+    if (GLEW_EXT_texture_filter_anisotropic) {
+        GLfloat maxAnisotropy = 1.f;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+        glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(maxAnisotropy, MAX_TEXTURE_ANISOTROPY));
+    }
+}
+
+GLint Texture::getMipmapLevelCount(GLsizei width, GLsizei height) {
+    // Chaine complete de mipmaps, jusqu'a 1x1
+    return 1 + GLint(std::floor(std::log2(float(std::max(width, height)))));
 }
 
 void Texture::activeAndBindTexture(GLenum tex, GLuint texture) {
-	glActiveTexture(tex);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    GLState::bindTexture(tex - GL_TEXTURE0, GL_TEXTURE_2D, texture);
+}
+
+GLuint Texture::createTextureArray(GLsizei layers, GLsizei width, GLsizei height, PixelFormat format, const glm::vec4 &placeholder) {
+    GLenum internalFormat, pixelFormat, type;
+    getGLFormat(format, internalFormat, pixelFormat, type);
+    GLuint texture;
+    glGenTextures(1, &texture);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    GLint levels = getMipmapLevelCount(width, height);
+    // Couleur unie dans chaque couche en attendant son image : un niveau est le debut du remplissage du niveau 0
+    Image fill(width, height, format);
+    fill.fill(placeholder);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (GLint level = 0; level < levels; level++) {
+        GLsizei levelWidth = std::max(1, width >> level), levelHeight = std::max(1, height >> level);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, levelWidth, levelHeight, layers, 0, pixelFormat, type, nullptr);
+        for (GLsizei l = 0; l < layers; l++) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, l, levelWidth, levelHeight, 1, pixelFormat, type, fill.getData());
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    setMipmapFiltering(GL_TEXTURE_2D_ARRAY);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    //debindage de la texture
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture;
+}
+
+void Texture::uploadTextureLayer(GLuint texture, GLsizei layer, GLsizei width, GLsizei height, Image &image) {
+    Image *source = &image;
+    std::unique_ptr<Image> resized;
+    if (image.getWidth() != (unsigned int)width || image.getHeight() != (unsigned int)height) {
+        // Reechantillonnage vers la taille commune des couches (normalement deja fait par le chargement)
+        resized = resizeImage(image, width, height);
+        source = resized.get();
+    }
+    if (source->getLevelCount() == 1) {
+        // Mipmaps de cette couche seulement, calculees par le CPU : glGenerateMipmap referait toutes les couches
+        source->generateMipmaps();
+    }
+    GLenum internalFormat, pixelFormat, type;
+    getGLFormat(source->getFormat(), internalFormat, pixelFormat, type);
+    GLint levels = std::min<GLint>(source->getLevelCount(), getMipmapLevelCount(width, height));
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (GLint level = 0; level < levels; level++) {
+        const Image &mipmap = source->getLevel(level);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, mipmap.getWidth(), mipmap.getHeight(), 1, pixelFormat, type, mipmap.getData());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    //debindage de la texture
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
 }
@@ -1,5 +1,8 @@
 #include <vector>
+#include <memory>
+#include <cstdlib>
 #include <cstddef>
+#include <cstdio>
 #include <iostream>
 #include <GL/glew.h>
 #include <c3ga/Mvec.hpp>
@@ -8,13 +11,34 @@
 #include <glimac/Tore.hpp>
 #include <glimac/Image.hpp>
 #include <glimac/Sphere.hpp>
+#include <glimac/LodMesh.hpp>
+#include <glimac/Frustum.hpp>
+#include <glimac/TransformBatch.hpp>
+#include <glimac/GeometryArena.hpp>
+#include <glimac/StreamBuffer.hpp>
+#include <glimac/FrameCapture.hpp>
+#include <glimac/Profiler.hpp>
+#include <glimac/RenderQueue.hpp>
+#include <glimac/GLState.hpp>
+#include <glimac/CameraUniforms.hpp>
+#include <glimac/SceneGraph.hpp>
+#include <glimac/Simulation.hpp>
+#include <glimac/JobSystem.hpp>
+#include <glimac/AssetLoader.hpp>
 #include <glimac/common.hpp>
+#include <glimac/PackedVertex.hpp>
 #include <glimac/Program.hpp>
+#include <glimac/ProgramManager.hpp>
 #include <glimac/FilePath.hpp>
 #include <glimac/Geometry.hpp>
 #include <../include/space/SkyBox.hpp>
 #include <glimac/SDLWindowManager.hpp>
 #include <../include/space/Texture.hpp>
+#include <../include/space/BodyRenderer.hpp>
+#include <../include/space/ModelRenderer.hpp>
+#include <../include/space/OrbitRenderer.hpp>
+#include <../include/space/Benchmark.hpp>
+#include <../include/space/DynamicResolution.hpp>
 #include <../include/glimac/FreeflyCamera.hpp>
 #include <../include/space/Transformation.hpp>
 
@@ -26,92 +50,173 @@ const GLuint VERTEX_ATTR_POSITION = 0;
 const GLuint VERTEX_ATTR_NORMAL = 1;
 const GLuint VERTEX_ATTR_TEXCOORD = 2;
 
-glm::mat4 drawPlanet(Sphere & sphere, TexProgram & program, Texture & tex, GLuint tex_planet, SDLWindowManager & windowManager, glm::mat4 & globalMVMatrix, 
-                     glm::mat4 & ProjMatrix, glm::vec3 & rotateGlobal, glm::vec3 & translate, glm::vec3 & scale, glm::vec3 & rotate, float speed) {
-    program.m_Program.use();
-    glUniform1i(program.uTexture, 0);
-    glm::mat4 MVMatrix = glm::rotate(globalMVMatrix, windowManager.getTime()*speed, rotateGlobal);
-    MVMatrix = glm::translate(MVMatrix, translate);
-    MVMatrix = glm::scale(MVMatrix, scale);
-    MVMatrix = glm::rotate(MVMatrix, windowManager.getTime(), rotate);
-    // Specify the value of a uniform variable for the current program object
-    glUniformMatrix4fv(program.uMVMatrix, 1, GL_FALSE, glm::value_ptr(MVMatrix));
-    glUniformMatrix4fv(program.uNormalMatrix, 1, GL_FALSE, glm::value_ptr(glm::transpose(glm::inverse(MVMatrix))));
-    glUniformMatrix4fv(program.uMVPMatrix, 1, GL_FALSE, glm::value_ptr(ProjMatrix * MVMatrix));
-    tex.activeAndBindTexture(GL_TEXTURE0, tex_planet);
-    glDrawArrays(GL_TRIANGLES, 0, sphere.getVertexCount());
-    glActiveTexture(GL_TEXTURE0);
-    tex.activeAndBindTexture(GL_TEXTURE0, 0);
-    glUniform1i(program.uTexture, 0);
-
-    return MVMatrix;
+// Ajoute au graphe de scene un astre qui tourne autour de son parent et sur lui-meme
+SceneNode addPlanet(SceneGraph & scene, SceneNode parent, const glm::vec3 & orbitAxis, float speed,
+                    const glm::vec3 & translate, const glm::vec3 & scale, const glm::vec3 & rotate) {
+    SceneNode node = scene.addNode(parent, translate, scale);
+    scene.setOrbit(node, orbitAxis, speed);
+    scene.setSpin(node, rotate, 1.f);
+    return node;
 }
 
-Tore initTore(float ri, float re, GLuint & vbo_tore, GLuint & vao_tore) {
-    // Trajectoire
-    Tore tore(ri, re, 72, 36);
-
-    glGenBuffers(1, &vbo_tore);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_tore);
-
-    glBufferData(GL_ARRAY_BUFFER, tore.getVertexCount() * sizeof(ShapeVertex), tore.getDataPointer(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    glGenVertexArrays(1, &vao_tore);
-    glBindVertexArray(vao_tore);
-    
-    glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-    glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
-    glEnableVertexAttribArray(VERTEX_ATTR_TEXCOORD);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_tore);
-
-    glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE,  sizeof(ShapeVertex), (const GLvoid *)(offsetof(ShapeVertex, position)));
-    glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE,  sizeof(ShapeVertex), (const GLvoid *)(offsetof(ShapeVertex, normal)));
-    glVertexAttribPointer(VERTEX_ATTR_TEXCOORD, 2, GL_FLOAT, GL_FALSE,  sizeof(ShapeVertex), (const GLvoid *)(offsetof(ShapeVertex, texCoords)));
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    return tore;
+// Astre dessine a la position d'un noeud du graphe de scene
+struct SceneBody {
+    SceneNode node;
+    GLfloat layer;
+};
+
+// Niveaux de detail (du plus fin au plus grossier) et erreur tolere a l'ecran en pixels
+const std::vector<glm::ivec2> SPHERE_LODS = { {128, 64}, {64, 32}, {32, 16}, {16, 8}, {8, 4} };
+const std::vector<glm::ivec2> TORE_LODS = { {144, 72}, {72, 36}, {36, 18}, {18, 9} };
+const GLfloat LOD_MAX_PIXEL_ERROR = 0.5f;
+
+// Trajectoires des planetes, de Mercure a Neptune : rayon de l'orbite
+const std::vector<GLfloat> TRAJECTORY_RADII = { 16.5, 24.5, 30.5, 42, 63, 88, 108, 135 };
+
+// Etat d'un tore, applique par la file de rendu juste avant son dessin
+struct ToreDrawData {
+    const LayerTexProgram * program;
+    glm::mat4 ModelMatrix;
+    GLfloat layer;
+    VertexQuantization quantization;
+};
+
+void setToreState(const void * data) {
+    const ToreDrawData & tore = *static_cast<const ToreDrawData*>(data);
+    glUniform1f(tore.program->uLayer, tore.layer);
+    glUniform3fv(tore.program->uPositionScale, 1, glm::value_ptr(tore.quantization.scale));
+    glUniform3fv(tore.program->uPositionBias, 1, glm::value_ptr(tore.quantization.bias));
+    glUniformMatrix4fv(tore.program->uModelMatrix, 1, GL_FALSE, glm::value_ptr(tore.ModelMatrix));
 }
 
-void drawTore(Tore & tore, GLuint & vao_tore, TexProgram & saturneProgram, glm::mat4 & globalMVMatrix, SDLWindowManager & windowManager, GLuint texture, 
-              glm::mat4 & ProjMatrix, glm::vec3 & translateSaturne) {
-    glBindVertexArray(vao_tore);
-
-    saturneProgram.m_Program.use();
-    glm::mat4 toreMVMatrix = glm::rotate(globalMVMatrix, windowManager.getTime() * 0.5f, glm::vec3(0, 1, 0)); // Translation * Rotation
-    toreMVMatrix = glm::rotate(toreMVMatrix, 80.0f, glm::vec3(1, 0, 0));
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glUniform1i(saturneProgram.uTexture, 0);
-    glUniformMatrix4fv(saturneProgram.uMVMatrix, 1, GL_FALSE, glm::value_ptr(toreMVMatrix));
-    glUniformMatrix4fv(saturneProgram.uMVPMatrix, 1, GL_FALSE, glm::value_ptr(ProjMatrix * toreMVMatrix));
-    glUniformMatrix4fv(saturneProgram.uNormalMatrix, 1, GL_FALSE, glm::value_ptr(glm::transpose(glm::inverse(toreMVMatrix))));
-    glDrawArrays(GL_TRIANGLES, 0, tore.getVertexCount());
-
-    glBindVertexArray(0);
-}
+// Ajoute a la file le niveau de detail du tore adapte a sa taille a l'ecran, s'il est dans le champ
+// (frustum dans le repere du monde)
+void submitToreLod(RenderQueue & queue, const LodMesh & tore, GLfloat ri, GLfloat re, const GeometryArena & geometry, const MeshHandle & mesh,
+                   const LayerTexProgram & toreProgram, GLuint textureArray, GLfloat layer, const glm::mat4 & toreModelMatrix,
+                   const CameraUniforms & camera, const Frustum & frustum, GLfloat viewportHeight) {
+    glm::vec3 center;
+    GLfloat radius;
+    boundingSphere(tore.getBoundingBox(), center, radius);
+    GLfloat scale = glm::max(glm::length(glm::vec3(toreModelMatrix[0])), glm::max(glm::length(glm::vec3(toreModelMatrix[1])), glm::length(glm::vec3(toreModelMatrix[2]))));
+    glm::vec3 worldCenter = glm::vec3(toreModelMatrix * glm::vec4(center, 1));
+    if (!intersects(frustum, worldCenter, radius * scale)) {
+        return;
+    }
 
-void freeVboVao(GLuint & vbo, GLuint & vao) {
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
+    glm::mat4 MVMatrix = camera.ViewMatrix * toreModelMatrix;
+    glm::vec3 eye = glm::vec3(similarityInverse(MVMatrix)[3]); // camera dans le repere du tore
+    GLsizei l = tore.selectLevel(toreDistance(eye, ri, re), projectedPixelsPerUnit(camera.ProjMatrix, viewportHeight), LOD_MAX_PIXEL_ERROR);
+    const LodLevel & level = tore.getLevel(l);
+
+    RenderItem item;
+    item.program = toreProgram.m_Program.getGLId();
+    item.vao = geometry.getVertexArray();
+    item.textureTarget = GL_TEXTURE_2D_ARRAY;
+    item.texture = textureArray;
+    item.textureUnit = TEXTURE_ARRAY_UNIT;
+    item.count = level.indexCount;
+    item.first = (mesh.firstIndex + level.firstIndex) * sizeof(GLuint);
+    item.baseVertex = mesh.baseVertex;
+
+    ToreDrawData data;
+    data.program = &toreProgram;
+    data.ModelMatrix = toreModelMatrix;
+    data.layer = layer;
+    data.quantization = mesh.quantization;
+    GLfloat viewZ = (camera.ViewMatrix * glm::vec4(worldCenter, 1)).z;
+    queue.submit(item, RENDER_PASS_OPAQUE, sortDepth(camera.ProjMatrix, viewZ), setToreState, data);
 }
 
 int main(int argc, char** argv) {
 	int width_windows = 1350;
     int height_windows = 700;
+    // Options de la ligne de commande
+    bool packedVertices = false; // sommets compacts (PackedShapeVertex) au lieu de ShapeVertex
+    bool glStats = false; // affichage des appels GL emis et evites
+    std::string modelPath; // modele OBJ (vaisseau, station...) en orbite autour de la Terre
+    int asteroidOrbits = 0; // orbites d'asteroides affichees entre Mars et Jupiter
+    bool headless = false; // rendu hors ecran, sans fenetre ni serveur d'affichage
+    unsigned int maxFrames = 0; // nombre de frames avant de quitter (0 : jusqu'a la fermeture)
+    std::string capturePath; // export des frames (.png, .y4m, .rgb)
+    std::string profilePath; // trace Chrome des temps CPU et GPU de chaque etape
+    unsigned int benchmarkFrames = 0; // frames mesurees en mode benchmark (0 : mode interactif)
+    std::string benchmarkPath = "benchmark.json"; // rapport du benchmark
+    double timeScale = 1.; // secondes simulees par seconde reelle
+    float resolutionBudget = 0.f; // temps GPU vise pour la scene en ms (resolution dynamique), 0 : resolution fixe
+    unsigned int jobThreads = 0; // threads du JobSystem (0 : un par coeur, 1 : execution sequentielle deterministe)
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--packed-vertices") { packedVertices = true; }
+        if (arg == "--gl-stats") { glStats = true; }
+        if (arg == "--model" && i + 1 < argc) { modelPath = argv[++i]; }
+        if (arg == "--asteroid-orbits" && i + 1 < argc) { asteroidOrbits = std::atoi(argv[++i]); }
+        if (arg == "--headless") { headless = true; }
+        if (arg == "--frames" && i + 1 < argc) { maxFrames = std::atoi(argv[++i]); }
+        if (arg == "--capture" && i + 1 < argc) { capturePath = argv[++i]; }
+        if (arg == "--profile" && i + 1 < argc) { profilePath = argv[++i]; }
+        if (arg == "--benchmark" && i + 1 < argc) { benchmarkFrames = std::atoi(argv[++i]); }
+        if (arg == "--benchmark-output" && i + 1 < argc) { benchmarkPath = argv[++i]; }
+        if (arg == "--time-scale" && i + 1 < argc) { timeScale = std::atof(argv[++i]); }
+        if (arg == "--dynamic-resolution" && i + 1 < argc) { resolutionBudget = std::atof(argv[++i]); }
+        if (arg == "--jobs" && i + 1 < argc) { jobThreads = std::atoi(argv[++i]); }
+        if (arg == "--size" && i + 1 < argc) {
+            int w = 0, h = 0;
+            if (std::sscanf(argv[++i], "%dx%d", &w, &h) == 2 && w > 0 && h > 0) {
+                width_windows = w;
+                height_windows = h;
+            }
+        }
+    }
     float ratio_h_w = (float)width_windows / (float)height_windows;
-    // Initialize SDL and open a window
-    SDLWindowManager windowManager(width_windows, height_windows, "Systeme solaire");
-
-    // Initialize glew for OpenGL3+ support
-    GLenum glewInitError = glewInit();
-    if (GLEW_OK != glewInitError) {
-        std::cerr << glewGetErrorString(glewInitError) << std::endl;
+    // Pool de threads partage par les travaux paralleles (maillages, textures...)
+    JobSystem::initialize(jobThreads);
+
+    // Decodage des textures en parallele, pendant la creation de la fenetre, la compilation des shaders et
+    // les premieres frames : chaque image est envoyee au GPU des qu'elle est prete
+    const GLsizei BODY_TEXTURE_WIDTH = 1024;
+    const GLsizei BODY_TEXTURE_HEIGHT = 512;
+    // Une couche de la texture array des astres par carte, dans l'ordre de BodyLayer
+    const std::vector<std::string> BODY_MAPS {
+        "SunMap.jpg", "MoonMap.jpg", "CloudMap.jpg", "EarthMap.jpg", "Mercure.jpg", "Venus.jpg",
+        "Mars.jpg", "Jupiter.jpg", "Saturne.jpg", "Uranus.jpg", "Neptune.jpg", "Callisto.jpg"
+    };
+    // Faces de la skybox
+    const std::vector<std::string> facesGalaxy {
+        TEXTURE_DIR + "/etoiles/right.png",
+        TEXTURE_DIR + "/etoiles/left.png",
+        TEXTURE_DIR + "/etoiles/top1.png",
+        TEXTURE_DIR + "/etoiles/bottom.png",
+        TEXTURE_DIR + "/etoiles/front.png",
+        TEXTURE_DIR + "/etoiles/back.png"
+    };
+    AssetLoader assets;
+    std::vector<std::string> assetPaths; // indice : identifiant de l'image dans assets
+    for (const std::string &map : BODY_MAPS) {
+        assetPaths.push_back(TEXTURE_DIR + "/" + map);
+        // Couleurs sRGB 8 bits, reechantillonnees a la taille commune des couches et mipmappees par le thread qui les decode
+        assets.loadImage(assetPaths.back(), PixelFormat::SRGB8_ALPHA8, BODY_TEXTURE_WIDTH, BODY_TEXTURE_HEIGHT, true);
+    }
+    for (const std::string &face : facesGalaxy) {
+        assetPaths.push_back(face);
+        assets.loadImage(face, PixelFormat::SRGB8_ALPHA8);
+    }
+    // Initialize SDL and open a window (or an offscreen framebuffer of the same size)
+    SDLWindowManager windowManager(width_windows, height_windows, "Systeme solaire", headless);
+    if (!windowManager.isValid()) {
         return EXIT_FAILURE;
     }
 
+    // Initialize glew for OpenGL3+ support (already done by the headless context)
+    if (!headless) {
+        GLenum glewInitError = glewInit();
+        if (GLEW_OK != glewInitError) {
+            std::cerr << glewGetErrorString(glewInitError) << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    // Etat GL inconnu de GLState jusqu'au premier appel de chaque sorte
+    GLState::invalidate();
+
     std::cout << "OpenGL Version : " << glGetString(GL_VERSION) << std::endl;
     std::cout << "GLEW Version : " << glewGetString(GLEW_VERSION) << std::endl;
 
@@ -119,48 +224,23 @@ int main(int argc, char** argv) {
      * HERE SHOULD COME THE INITIALIZATION CODE
      *********************************/
     FilePath applicationPath(argv[0]);
-    TexProgram earthProgram(applicationPath);
-    TexProgram sunProgram(applicationPath);
-    TexProgram moonProgram(applicationPath);
-    TexProgram mercureProgram(applicationPath);
-    TexProgram venusProgram(applicationPath);
-    TexProgram marsProgram(applicationPath);
-    TexProgram jupiterProgram(applicationPath);
-    TexProgram saturneProgram(applicationPath);
-    TexProgram uranusProgram(applicationPath);
-    TexProgram neptuneProgram(applicationPath);
-    TexProgram callistoProgram(applicationPath);
-    Skytext skytex(applicationPath);
-
-    // Sphere pour les planetes
+    // Les programmes identiques sont partages et leurs binaires gardes entre deux lancements
+    ProgramManager::setCacheDirectory(applicationPath.dirPath() + "shader_cache");
+    LayerTexProgram toreProgram(applicationPath, packedVertices);
+    InstancedTexProgram bodiesProgram(applicationPath, packedVertices);
+    Skytext skytex(applicationPath, packedVertices);
+
+    // Sphere pour les transformations c3ga des planetes
     Sphere sphere(1, 32, 16); // rayon = 1, latitude = 32, longitude = 16
+    // Maillages des planetes, du plus fin au plus grossier (niveaux construits en parallele)
+    LodMesh sphereLod = buildSphereLod(1, SPHERE_LODS);
     // Tore pour l'anneau de Saturne
-    Tore tore(0.5, 3, 72, 36); // rayon_interne = 0.1, rayon_externe = 1
-
-    // Trajectoire de Mercure
-    GLuint vbo_mercure, vao_mercure;
-    Tore TrajectoireMercure = initTore(0.2, 16.5, vbo_mercure, vao_mercure);
-    // Trajectoire de Venus
-    GLuint vbo_venus, vao_venus;
-    Tore TrajectoireVenus = initTore(0.2, 24.5, vbo_venus, vao_venus);
-    // Trajectoire de la Terre
-    GLuint vbo_terre, vao_terre;
-    Tore TrajectoireTerre = initTore(0.2, 30.5, vbo_terre, vao_terre);
-    // Trajectoire de Mars
-    GLuint vbo_mars, vao_mars;
-    Tore TrajectoireMars = initTore(0.2, 42, vbo_mars, vao_mars);
-    // Trajectoire de Jupiter
-    GLuint vbo_jupiter, vao_jupiter;
-    Tore TrajectoireJupiter = initTore(0.2, 63, vbo_jupiter, vao_jupiter);
-    // Trajectoire de Saturne
-    GLuint vbo_saturne, vao_saturne;
-    Tore TrajectoireSaturne = initTore(0.2, 88, vbo_saturne, vao_saturne);
-    // Trajectoire de Uranus
-    GLuint vbo_uranus, vao_uranus;
-    Tore TrajectoireUranus = initTore(0.2, 108, vbo_uranus, vao_uranus);
-    // Trajectoire de Neptune
-    GLuint vbo_neptune, vao_neptune;
-    Tore TrajectoireNeptune = initTore(0.2, 135, vbo_neptune, vao_neptune);
+    LodMesh tore = buildToreLod(0.5, 3, TORE_LODS); // rayon_interne = 0.5, rayon_externe = 3
+
+    // Tous les maillages statiques sont ranges dans un seul VBO/IBO, decrits par un seul VAO
+    GeometryArena geometry(packedVertices, VERTEX_ATTR_POSITION, VERTEX_ATTR_NORMAL, VERTEX_ATTR_TEXCOORD);
+    MeshHandle sphereMesh = geometry.add(sphereLod);
+    MeshHandle toreMesh = geometry.add(tore);
     
     /* SkyBox */
     float size_cube = 1;
@@ -175,97 +255,45 @@ int main(int argc, char** argv) {
         verticesSkybox[i].position.z += 0.5;
         Datapointeur_skybox++;
     }
-    SkyBox skybox(count_vertex_skybox, verticesSkybox);
+    SkyBox skybox(geometry, count_vertex_skybox, verticesSkybox, cubeSkybox.getIndexCount(), cubeSkybox.getIndexPointer());
+    geometry.upload();
 
-    GLuint texSpatial;
-    // Texture Spatial Skybox
-    std::vector<std::string> facesGalaxy {
-        TEXTURE_DIR + "/etoiles/right.png",
-        TEXTURE_DIR + "/etoiles/left.png",
-        TEXTURE_DIR + "/etoiles/top1.png",
-        TEXTURE_DIR + "/etoiles/bottom.png",
-        TEXTURE_DIR + "/etoiles/front.png",
-        TEXTURE_DIR + "/etoiles/back.png"
-    };
-    //Binding de la texture Spatial
-    texSpatial = skybox.loadCubemap(facesGalaxy);
-    float distRendu = 5000.0f;
+    // Texture Spatial Skybox : noire jusqu'a l'arrivee de ses six faces
+    GLuint texSpatial = skybox.createCubemap();
+    std::vector<std::unique_ptr<Image>> skyboxFaces(facesGalaxy.size());
+    size_t skyboxFacesLoaded = 0;
     /***************************/
 
     /* Textures planetes */
     Texture tex;
-    std::unique_ptr<Image> SunMap = loadImage("../assets/textures/SunMap.jpg");
-    std::unique_ptr<Image> MoonMap = loadImage("../assets/textures/MoonMap.jpg");
-    std::unique_ptr<Image> CloudMap = loadImage("../assets/textures/CloudMap.jpg");
-    std::unique_ptr<Image> EarthMap = loadImage("../assets/textures/EarthMap.jpg");
-    std::unique_ptr<Image> MercureMap = loadImage("../assets/textures/Mercure.jpg");
-    std::unique_ptr<Image> VenusMap = loadImage("../assets/textures/Venus.jpg");
-    std::unique_ptr<Image> MarsMap = loadImage("../assets/textures/Mars.jpg");
-    std::unique_ptr<Image> JupiterMap = loadImage("../assets/textures/Jupiter.jpg");
-    std::unique_ptr<Image> SaturneMap = loadImage("../assets/textures/Saturne.jpg");
-    std::unique_ptr<Image> UranusMap = loadImage("../assets/textures/Uranus.jpg");
-    std::unique_ptr<Image> NeptuneMap = loadImage("../assets/textures/Neptune.jpg");
-    std::unique_ptr<Image> CallistoMap = loadImage("../assets/textures/Callisto.jpg");
-    if (SunMap == NULL || MoonMap == NULL || CloudMap == NULL || EarthMap == NULL
-        || MercureMap == NULL || VenusMap == NULL || MarsMap == NULL || JupiterMap == NULL
-        || SaturneMap == NULL || UranusMap == NULL || NeptuneMap == NULL || CallistoMap == NULL) {
-        std::cerr << "Une des textures n'a pas pu etre chargée. \n" << std::endl;
-        exit(0);
-    }
-    GLuint texture[12];
-    glGenTextures(11, texture);
-    tex.firstBindTexture(SunMap, texture[0]); //Binding de la texture SunMap
-    tex.firstBindTexture(MoonMap, texture[1]); //Binding de la texture MoonMap
-    tex.firstBindTexture(CloudMap, texture[2]); //Binding de la texture CloudMap
-    tex.firstBindTexture(EarthMap, texture[3]); //Binding de la texture EarthMap
-    tex.firstBindTexture(MercureMap, texture[4]); //Binding de la texture MercureMap
-    tex.firstBindTexture(VenusMap, texture[5]); //Binding de la texture VenusMap
-    tex.firstBindTexture(MarsMap, texture[6]); //Binding de la texture MarsMap
-    tex.firstBindTexture(JupiterMap, texture[7]); //Binding de la texture JupiterMap
-    tex.firstBindTexture(SaturneMap, texture[8]); //Binding de la texture SaturneMap
-    tex.firstBindTexture(UranusMap, texture[9]); //Binding de la texture UranusMap
-    tex.firstBindTexture(NeptuneMap, texture[10]); //Binding de la texture NeptuneMap
-    tex.firstBindTexture(CallistoMap, texture[11]); //Binding de la texture CallistoMap
+    // Texture array des astres : une couche par carte, grise jusqu'a l'arrivee de son image
+    enum BodyLayer { SUN, MOON, CLOUD, EARTH, MERCURE, VENUS, MARS, JUPITER, SATURNE, URANUS, NEPTUNE, CALLISTO };
+    GLuint texBodies = tex.createTextureArray(BODY_MAPS.size(), BODY_TEXTURE_WIDTH, BODY_TEXTURE_HEIGHT,
+                                              PixelFormat::SRGB8_ALPHA8, glm::vec4(0.5f, 0.5f, 0.5f, 1.f));
+    // Envoi au GPU d'une image decodee (sur le thread GL), la texture gardant son remplacant en cas d'echec
+    auto uploadImage = [&](unsigned int id, std::unique_ptr<Image> image) {
+        if (!image) {
+            std::cerr << "La texture " << assetPaths[id] << " n'a pas pu etre chargee." << std::endl;
+            return;
+        }
+        if (id < BODY_MAPS.size()) {
+            tex.uploadTextureLayer(texBodies, id, BODY_TEXTURE_WIDTH, BODY_TEXTURE_HEIGHT, *image);
+        }
+        else {
+            skyboxFaces[id - BODY_MAPS.size()] = std::move(image);
+            if (++skyboxFacesLoaded == skyboxFaces.size()) {
+                skybox.uploadCubemap(texSpatial, skyboxFaces);
+                skyboxFaces.clear();
+            }
+        }
+    };
     /***************************/
 
     /* Sphere : planetes */
-    GLuint vbo;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sphere.getVertexCount() * sizeof(ShapeVertex), sphere.getDataPointer(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    GLuint vao;
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-    glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
-    glEnableVertexAttribArray(VERTEX_ATTR_TEXCOORD);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE,  sizeof(ShapeVertex), (const GLvoid *)(offsetof(ShapeVertex, position)));
-    glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE,  sizeof(ShapeVertex), (const GLvoid *)(offsetof(ShapeVertex, normal)));
-    glVertexAttribPointer(VERTEX_ATTR_TEXCOORD, 2, GL_FLOAT, GL_FALSE,  sizeof(ShapeVertex), (const GLvoid *)(offsetof(ShapeVertex, texCoords)));
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    /***************************/
-
-    /* Tore : anneau de saturne */
-    GLuint vbo_tore;
-    glGenBuffers(1, &vbo_tore);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_tore);
-    glBufferData(GL_ARRAY_BUFFER, tore.getVertexCount() * sizeof(ShapeVertex), tore.getDataPointer(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    GLuint vao_tore;
-    glGenVertexArrays(1, &vao_tore);
-    glBindVertexArray(vao_tore);
-    glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-    glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
-    glEnableVertexAttribArray(VERTEX_ATTR_TEXCOORD);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_tore);
-    glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE,  sizeof(ShapeVertex), (const GLvoid *)(offsetof(ShapeVertex, position)));
-    glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE,  sizeof(ShapeVertex), (const GLvoid *)(offsetof(ShapeVertex, normal)));
-    glVertexAttribPointer(VERTEX_ATTR_TEXCOORD, 2, GL_FLOAT, GL_FALSE,  sizeof(ShapeVertex), (const GLvoid *)(offsetof(ShapeVertex, texCoords)));
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // Tous les astres sont dessines par appels instancies sur la sphere de l'arena, un par niveau de detail
+    // Donnees reecrites a chaque frame (camera, instances), sans synchronisation implicite avec le GPU
+    StreamBuffer frameData(1 << 20);
+    BodyRenderer bodies(geometry, sphereMesh, sphereLod, frameData);
     /***************************/
 
     /* Transformations appliquer aux planetes */
@@ -361,6 +389,72 @@ int main(int argc, char** argv) {
         glm::vec3 rotateCallisto = rotateMercure;
     /***************************/
 
+    /* Graphe de scene : les satellites suivent leur planete, les parties fixes sont calculees une fois */
+    SceneGraph scene;
+    SceneNode sunNode = scene.addNode(NO_PARENT, glm::vec3(0), glm::vec3(5, 5, 5));
+    scene.setOrbit(sunNode, rotateGlobal, 1.f);
+    SceneNode earthNode = addPlanet(scene, NO_PARENT, rotateGlobal, 1, translateEarth, scaleEarth, rotateEarth);
+    SceneNode jupiterNode = addPlanet(scene, NO_PARENT, rotateGlobal, 1.4, translateJupiter, scaleJupiter, rotateJupiter);
+    std::vector<SceneBody> sceneBodies = {
+        { sunNode, SUN },
+        { addPlanet(scene, NO_PARENT, rotateGlobal, 0.6, translateMercure, scaleMercure, rotateMercure), MERCURE },
+        { addPlanet(scene, NO_PARENT, rotateGlobal, 0.8, translateVenus, scaleVenus, rotateVenus), VENUS },
+        { earthNode, EARTH },
+        { addPlanet(scene, NO_PARENT, rotateGlobal, 1.2, translateMars, scaleMars, rotateMars), MARS },
+        { jupiterNode, JUPITER },
+        { addPlanet(scene, NO_PARENT, rotateGlobal, 0.5, translateSaturne, scaleSaturne, rotateSaturne), SATURNE },
+        { addPlanet(scene, NO_PARENT, rotateGlobal, 1, translateUranus, scaleUranus, rotateUranus), URANUS },
+        { addPlanet(scene, NO_PARENT, rotateGlobal, 1.5, translateNeptune, scaleNeptune, rotateNeptune), NEPTUNE },
+        // Lune autour de la Terre
+        { addPlanet(scene, earthNode, translateEarth, 1, translateLune, scaleLune, rotateLune), MOON },
+        // Callisto autour de Jupiter
+        { addPlanet(scene, jupiterNode, translateJupiter, 1.4, translateCallisto, scaleCallisto, rotateCallisto), CALLISTO }
+    };
+    // Anneau de Saturne
+    SceneNode ringNode = scene.addNode(NO_PARENT, translateSaturne - glm::vec3(0, 2, -0.2));
+    scene.setOrbit(ringNode, glm::vec3(0, 1, 0), 0.5f);
+    scene.setTilt(ringNode, 80.0f, glm::vec3(1, 0, 0));
+    /***************************/
+
+    /* Trajectoires : un cercle par planete (et une ellipse par asteroide), toutes en un seul dessin */
+    OrbitProgram orbitProgram(applicationPath);
+    OrbitRenderer orbits;
+    for (GLfloat radius : TRAJECTORY_RADII) {
+        orbits.addOrbit(radius, 0, 0, 0, glm::vec4(0.6, 0.6, 0.6, 1));
+    }
+    for (int i = 0; i < asteroidOrbits; i++) {
+        orbits.addOrbit(glm::linearRand(45.f, 60.f), glm::linearRand(0.f, 0.2f), glm::linearRand(-0.1f, 0.1f),
+                        glm::linearRand(0.f, 2.f * glm::pi<float>()), glm::vec4(0.4, 0.35, 0.3, 1));
+    }
+    /***************************/
+
+    /* Modele OBJ : un appel de dessin par materiau, quel que soit le nombre de sous-maillages */
+    std::unique_ptr<ModelProgram> modelProgram;
+    std::unique_ptr<ModelRenderer> model;
+    SceneNode modelNode = NO_PARENT;
+    if (!modelPath.empty()) {
+        Geometry modelGeometry;
+        // Les .mtl sont cherches a cote du .obj
+        std::string modelDir = FilePath(modelPath).dirPath();
+        if (!modelDir.empty()) { modelDir += FilePath::PATH_SEPARATOR; }
+        if (!GLEW_VERSION_4_3) {
+            std::cerr << "--model necessite OpenGL 4.3 (multi draw indirect), modele ignore" << std::endl;
+        }
+        else if (modelGeometry.loadOBJ(modelPath, modelDir)) {
+            modelProgram.reset(new ModelProgram(applicationPath));
+            model.reset(new ModelRenderer(modelGeometry));
+            // Ramene a un rayon de 0.5 et place au-dessus de la Terre
+            glm::vec3 center;
+            GLfloat radius;
+            boundingSphere(model->getBoundingBox(), center, radius);
+            modelNode = scene.addNode(earthNode, glm::vec3(0, 2, 0), glm::vec3(0.5f / radius));
+            scene.setSpin(modelNode, glm::vec3(0, 1, 0), 0.3f);
+            std::cout << "Modele : " << modelGeometry.getMeshCount() << " sous-maillages, "
+                      << model->getDrawCount() << " appels de dessin" << std::endl;
+        }
+    }
+    /***************************/
+
     
     bool flag = false;
     bool done = false;
@@ -369,10 +463,61 @@ int main(int argc, char** argv) {
     glm::ivec2 lastmousePos;
     float defaultspeed = 0.5;
     float boost_speed = 0.5;
-    glm::mat4 ProjMatrix = glm::perspective(glm::radians(70.f), 800.f/600.f, 0.1f, 10000.f);
+    // Meme projection pour la skybox et les astres
+    glm::mat4 ProjMatrix = glm::perspective(glm::radians(70.f), ratio_h_w, 0.1f, 10000.f);
+    // Vue, projection et temps de la frame, partages par tous les programmes
+    CameraUniformBuffer cameraBuffer;
+    // File de rendu, remplie puis videe a chaque frame
+    RenderQueue renderQueue;
+    // Export des frames : relues de facon asynchrone et encodees par des threads de travail
+    std::unique_ptr<FrameCapture> capture;
+    if (!capturePath.empty()) {
+        capture.reset(new FrameCapture(width_windows, height_windows, capturePath));
+    }
+    // Resolution dynamique : scene rendue hors ecran a une echelle ajustee au budget, puis agrandie
+    std::unique_ptr<DynamicResolution> resolution;
+    std::unique_ptr<UpscaleProgram> upscaleProgram;
+    if (resolutionBudget > 0.f) {
+        upscaleProgram.reset(new UpscaleProgram(applicationPath));
+        resolution.reset(new DynamicResolution(width_windows, height_windows, resolutionBudget));
+    }
+    // Mesures CPU et GPU des etapes de la frame (sans effet si desactive)
+    Profiler::setEnabled(!profilePath.empty() || benchmarkFrames != 0);
+    // Benchmark : temps fixe par frame et camera scriptee, la frame suivante ne depend que de son indice
+    std::unique_ptr<Benchmark> benchmark;
+    if (benchmarkFrames != 0) {
+        benchmark.reset(new Benchmark(benchmarkFrames));
+        maxFrames = benchmark->getTotalFrames();
+    }
+    // Simulation a pas fixe sur son propre thread, sauf en benchmark ou chaque frame calcule son propre instant.
+    // Le graphe de scene lui appartient ensuite : le rendu n'utilise que les matrices qu'elle publie.
+    std::unique_ptr<Simulation> simulation;
+    if (!benchmark) {
+        simulation.reset(new Simulation(scene));
+        simulation->setTimeScale(timeScale);
+        simulation->start();
+    }
+    // Les mesures et les exports commencent avec toutes les textures
+    if (benchmark || capture) {
+        assets.wait();
+    }
+    std::vector<glm::mat4> worldMatrices; // matrices des noeuds pour la frame
+    unsigned int frame = 0;
     // Application loop:
     while (!done) {
+        Profiler::newFrame();
+        ProfileScope frameScope("frame");
+        GLState::newFrame();
+        if (glStats && frame % 100 == 0) {
+            GLState::Counters counters = GLState::getFrameCounters();
+            std::cout << "Etat GL : " << counters.issued << " appels emis, " << counters.elided << " evites" << std::endl;
+        }
+        frame++;
+        if (maxFrames != 0 && frame >= maxFrames) {
+            done = true; // Derniere frame
+        }
         // Event loop:
+        Profiler::begin("events");
         SDL_Event e;
         while (windowManager.pollEvent(e)) {
             if (e.type == SDL_QUIT || windowManager.isKeyPressed(SDLK_ESCAPE)) {
@@ -402,161 +547,129 @@ int main(int argc, char** argv) {
         if (windowManager.isKeyPressed(SDLK_s) == true) { Camera.moveFront(-speedcam); }
 
         if (windowManager.isKeyPressed(SDLK_d) == true) { Camera.moveLeft(-speedcam); }
+        Profiler::end();
         /***************************/
 
+        // Textures decodees depuis la frame precedente
+        if (assets.getPendingCount() > 0) {
+            ProfileScope assetsScope("assets");
+            assets.update(uploadImage);
+        }
+
         /*********************************
          * HERE SHOULD COME THE RENDERING CODE
          *********************************/
         // Nettoyage de la fenêtre
+        if (resolution) {
+            resolution->beginScene();
+        }
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Hauteur de la zone de rendu, pour le choix des niveaux de detail
+        GLsizei viewportHeight = resolution ? resolution->getRenderHeight() : height_windows;
+        bodies.setLodParameters(viewportHeight, LOD_MAX_PIXEL_ERROR);
+        frameData.beginFrame();
+
+        // Donnees de la frame, envoyees une seule fois
+        // Etat de la simulation interpole entre ses deux derniers pas
+        Profiler::begin("update");
+        double time;
+        if (simulation) {
+            time = simulation->interpolate(worldMatrices);
+        } else {
+            time = benchmark->getTime(frame - 1);
+            scene.update(time);
+            worldMatrices.resize(scene.getNodeCount());
+            for (GLsizei node = 0; node < scene.getNodeCount(); node++) {
+                worldMatrices[node] = scene.getWorldMatrix(node);
+            }
+        }
+        Profiler::end();
+        glm::mat4  VMatrix = benchmark ? benchmark->getViewMatrix(frame - 1) : Camera.getViewMatrix();
+        cameraBuffer.update(frameData, VMatrix, ProjMatrix, time);
+        const CameraUniforms & camera = cameraBuffer.getUniforms();
+        Frustum frustum = extractFrustum(camera.ViewProjMatrix);
 
         // Affichage de la skybox
-        glm::mat4  VMatrix = Camera.getViewMatrix();
-        skybox.activeSkyBox(skytex, texSpatial, distRendu, ratio_h_w, VMatrix);
-
-        glBindVertexArray(vao);
-        glm::mat4 globalMVMatrix = Camera.getViewMatrix();
-
-        // Soleil
-        sunProgram.m_Program.use();
-        glUniform1i(sunProgram.uTexture, 0);
-        glm::mat4 sunMVMatrix = glm::rotate(globalMVMatrix, windowManager.getTime(), rotateGlobal);
-        sunMVMatrix = glm::scale(sunMVMatrix, glm::vec3(5, 5, 5));
-        glUniformMatrix4fv(sunProgram.uMVMatrix, 1, GL_FALSE, glm::value_ptr(sunMVMatrix));
-        glUniformMatrix4fv(sunProgram.uNormalMatrix, 1, GL_FALSE, glm::value_ptr(glm::transpose(glm::inverse(sunMVMatrix))));
-        glUniformMatrix4fv(sunProgram.uMVPMatrix, 1, GL_FALSE, glm::value_ptr(ProjMatrix * sunMVMatrix));
-        tex.activeAndBindTexture(GL_TEXTURE0, texture[0]);
-        glDrawArrays(GL_TRIANGLES, 0, sphere.getVertexCount());
-        glActiveTexture(GL_TEXTURE0);
-        tex.activeAndBindTexture(GL_TEXTURE0, 0);
-        glUniform1i(sunProgram.uTexture, 0);
-
-        // Mercure
-        drawPlanet(sphere, mercureProgram, tex, texture[4], windowManager,
-            globalMVMatrix, ProjMatrix, rotateGlobal, translateMercure, scaleMercure, rotateMercure, 0.6);
-
-        // Venus
-        drawPlanet(sphere, venusProgram, tex, texture[5], windowManager,
-            globalMVMatrix, ProjMatrix, rotateGlobal, translateVenus, scaleVenus, rotateVenus, 0.8);
-
-        // Terre
-        glm::mat4 earthMVMatrix = drawPlanet(sphere, earthProgram, tex, texture[3], windowManager,
-            globalMVMatrix, ProjMatrix, rotateGlobal, translateEarth, scaleEarth, rotateEarth, 1);
-
-        // Mars
-        drawPlanet(sphere, marsProgram, tex, texture[6], windowManager,
-            globalMVMatrix, ProjMatrix, rotateGlobal, translateMars, scaleMars, rotateMars, 1.2);
-
-        // Jupiter
-        glm::mat4 jupiterMVMatrix = drawPlanet(sphere, jupiterProgram, tex, texture[7], windowManager,
-            globalMVMatrix, ProjMatrix, rotateGlobal, translateJupiter, scaleJupiter, rotateJupiter, 1.4);
-
-        // Saturne
-        drawPlanet(sphere, saturneProgram, tex, texture[8], windowManager,
-            globalMVMatrix, ProjMatrix, rotateGlobal, translateSaturne, scaleSaturne, rotateSaturne, 0.5);
-
-        // Uranus
-        drawPlanet(sphere, uranusProgram, tex, texture[9], windowManager,
-            globalMVMatrix, ProjMatrix, rotateGlobal, translateUranus, scaleUranus, rotateUranus, 1);
-
-        // Neptune
-        drawPlanet(sphere, neptuneProgram, tex, texture[10], windowManager,
-            globalMVMatrix, ProjMatrix, rotateGlobal, translateNeptune, scaleNeptune, rotateNeptune, 1.5);
-
-        // Lune autour de la Terre
-        moonProgram.m_Program.use();
-        glUniform1i(moonProgram.uTexture, 0);
-        glm::mat4 moonMVMatrix = glm::rotate(earthMVMatrix, windowManager.getTime()*1, translateEarth);
-        moonMVMatrix = glm::translate(moonMVMatrix, translateLune);
-        moonMVMatrix = glm::scale(moonMVMatrix, scaleLune);
-        moonMVMatrix = glm::rotate(moonMVMatrix, windowManager.getTime(), rotateLune);
-        glUniformMatrix4fv(moonProgram.uMVMatrix, 1, GL_FALSE, glm::value_ptr(moonMVMatrix));
-        glUniformMatrix4fv(moonProgram.uNormalMatrix, 1, GL_FALSE, glm::value_ptr(glm::transpose(glm::inverse(moonMVMatrix))));
-        glUniformMatrix4fv(moonProgram.uMVPMatrix, 1, GL_FALSE, glm::value_ptr(ProjMatrix * moonMVMatrix));
-        tex.activeAndBindTexture(GL_TEXTURE0, texture[1]);
-        glDrawArrays(GL_TRIANGLES, 0, earthSphere.getVertexCount());
-        glActiveTexture(GL_TEXTURE0);
-        tex.activeAndBindTexture(GL_TEXTURE0, 0);
-        glUniform1i(moonProgram.uTexture, 0);
+        Profiler::begin("skybox");
+        renderQueue.clear();
+        renderQueue.setStage("skybox");
+        skybox.activeSkyBox(renderQueue, skytex, texSpatial);
+        Profiler::end();
+
+        // Soleil, planetes et satellites : un appel instancie par niveau de detail utilise
+        // Les astres sont places dans le repere du monde, la vue est appliquee par les shaders
+        Profiler::begin("planets");
+        renderQueue.setStage("planets");
+        bodies.clear();
+        for (const SceneBody & body : sceneBodies) {
+            bodies.addInstance(worldMatrices[body.node], body.layer);
+        }
+        bodies.submit(renderQueue, bodiesProgram, texBodies, camera);
 
-        // Callisto autour de Jupiter
-        callistoProgram.m_Program.use();
-        glUniform1i(callistoProgram.uTexture, 0);
-        glm::mat4 callistoMVMatrix = glm::rotate(jupiterMVMatrix, windowManager.getTime()*1.4f, translateJupiter);
-        callistoMVMatrix = glm::translate(callistoMVMatrix, translateCallisto);
-        callistoMVMatrix = glm::scale(callistoMVMatrix, scaleCallisto);
-        callistoMVMatrix = glm::rotate(callistoMVMatrix, windowManager.getTime(), rotateCallisto);
-        glUniformMatrix4fv(callistoProgram.uMVMatrix, 1, GL_FALSE, glm::value_ptr(callistoMVMatrix));
-        glUniformMatrix4fv(callistoProgram.uNormalMatrix, 1, GL_FALSE, glm::value_ptr(glm::transpose(glm::inverse(callistoMVMatrix))));
-        glUniformMatrix4fv(callistoProgram.uMVPMatrix, 1, GL_FALSE, glm::value_ptr(ProjMatrix * callistoMVMatrix));
-        tex.activeAndBindTexture(GL_TEXTURE0, texture[11]);
-        glDrawArrays(GL_TRIANGLES, 0, earthSphere.getVertexCount());
-        glActiveTexture(GL_TEXTURE0);
-        tex.activeAndBindTexture(GL_TEXTURE0, 0);
-        glUniform1i(callistoProgram.uTexture, 0);
+        // Modele OBJ
+        if (model) {
+            model->submit(renderQueue, *modelProgram, worldMatrices[modelNode], camera, frustum);
+        }
 
         // Tore : anneau de Saturne
-        glBindVertexArray(vao_tore);
-        saturneProgram.m_Program.use();
-        glm::mat4 toreMVMatrix = glm::rotate(globalMVMatrix, windowManager.getTime() * 0.5f, glm::vec3(0, 1, 0)); // Translation * Rotation
-        toreMVMatrix = glm::translate(toreMVMatrix, translateSaturne - glm::vec3(0, 2, -0.2));
-        toreMVMatrix = glm::rotate(toreMVMatrix, 80.0f, glm::vec3(1,0,0));
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture[1]);
-        glUniform1i(saturneProgram.uTexture, 0);
-        glUniformMatrix4fv(saturneProgram.uMVMatrix, 1, GL_FALSE, glm::value_ptr(toreMVMatrix));
-        glUniformMatrix4fv(saturneProgram.uMVPMatrix, 1, GL_FALSE, glm::value_ptr(ProjMatrix * toreMVMatrix));
-        glUniformMatrix4fv(saturneProgram.uNormalMatrix, 1, GL_FALSE, glm::value_ptr(glm::transpose(glm::inverse(toreMVMatrix))));
-        glDrawArrays(GL_TRIANGLES, 0, tore.getVertexCount());
-        glBindVertexArray(0);
-
-        // Trajectoire de Mercure
-        drawTore(TrajectoireMercure, vao_mercure, sunProgram, globalMVMatrix, windowManager,
-            texture[1], ProjMatrix, translateMercure);
-
-        // Trajectoire de Venus
-        drawTore(TrajectoireVenus, vao_venus, sunProgram, globalMVMatrix, windowManager,
-            texture[1], ProjMatrix, translateVenus);
-
-        // Trajectoire de la Terre
-        drawTore(TrajectoireTerre, vao_terre, sunProgram, globalMVMatrix, windowManager,
-            texture[1], ProjMatrix, translateEarth);
-
-        // Trajectoire de Mars
-        drawTore(TrajectoireMars, vao_mars, sunProgram, globalMVMatrix, windowManager,
-            texture[1], ProjMatrix, translateMars);
-
-        // Trajectoire de Jupiter
-        drawTore(TrajectoireJupiter, vao_jupiter, sunProgram, globalMVMatrix, windowManager,
-            texture[1], ProjMatrix, translateJupiter);
-
-        // Trajectoire de Saturne
-        drawTore(TrajectoireSaturne, vao_saturne, sunProgram, globalMVMatrix, windowManager,
-            texture[1], ProjMatrix, translateSaturne);
-
-        // Trajectoire de Uranus
-        drawTore(TrajectoireUranus, vao_uranus, sunProgram, globalMVMatrix, windowManager,
-            texture[1], ProjMatrix, translateUranus);
-
-        // Trajectoire de Neptune
-        drawTore(TrajectoireNeptune, vao_neptune, sunProgram, globalMVMatrix, windowManager,
-            texture[1], ProjMatrix, translateNeptune);
+        submitToreLod(renderQueue, tore, 0.5, 3, geometry, toreMesh, toreProgram, texBodies, MOON, worldMatrices[ringNode],
+                      camera, frustum, viewportHeight);
+        Profiler::end();
+
+        // Trajectoires des planetes et des asteroides
+        Profiler::begin("orbits");
+        renderQueue.setStage("orbits");
+        orbits.submit(renderQueue, orbitProgram, glm::mat4(1.f));
+        Profiler::end();
+
+        // Les dessins sont tries (passe, programme, VAO, texture, profondeur) puis executes
+        // en ne changeant que l'etat qui differe d'un dessin au suivant
+        Profiler::begin("draw");
+        renderQueue.sort();
+        frameData.unmap();
+        renderQueue.execute();
+        frameData.endFrame();
+        Profiler::end();
+        if (resolution) {
+            ProfileScope upscaleScope("upscale", true);
+            resolution->endScene(windowManager.getFramebuffer(), *upscaleProgram);
+        }
+        if (capture) {
+            ProfileScope captureScope("capture");
+            capture->capture(windowManager.getFramebuffer());
+        }
 
         // Update the display
+        Profiler::begin("swap");
         windowManager.swapBuffers();
+        Profiler::end();
+        if (benchmark) {
+            benchmark->endFrame();
+        }
+    }
+
+    if (capture) {
+        capture->finish();
+        std::cout << "Capture : " << capture->getCapturedCount() << " frames exportees, "
+                  << capture->getDroppedCount() << " abandonnees" << std::endl;
+    }
+
+    if (!profilePath.empty()) {
+        if (Profiler::writeChromeTrace(profilePath)) {
+            std::cout << "Trace ecrite dans " << profilePath << " (chrome://tracing)" << std::endl;
+        } else {
+            std::cerr << "Impossible d'ecrire " << profilePath << std::endl;
+        }
+    }
+    if (benchmark && !benchmark->writeReport(benchmarkPath)) {
+        std::cerr << "Impossible d'ecrire " << benchmarkPath << std::endl;
     }
+    Profiler::shutdown();
+    JobSystem::shutdown();
 
-    // Liberation de la memoire
-    freeVboVao(vbo_mercure, vao_mercure);
-    freeVboVao(vbo_venus, vao_venus);
-    freeVboVao(vbo_terre, vao_terre);
-    freeVboVao(vbo_mars, vao_mars);
-    freeVboVao(vbo_jupiter, vao_jupiter);
-    freeVboVao(vbo_saturne, vao_saturne);
-    freeVboVao(vbo_uranus, vao_uranus);
-    freeVboVao(vbo_neptune, vao_neptune);
-    freeVboVao(vbo_tore, vao_tore);
-    freeVboVao(vbo, vao);
+    // Liberation de la memoire (les buffers de l'arena sont liberes par son destructeur)
+    GLState::deleteTextures(1, &texBodies);
+    ProgramManager::clear();
 
     return EXIT_SUCCESS;
 }